@@ -0,0 +1,31 @@
+#include "Agent.h"
+
+std::unique_ptr<Agent> make_agent(AgentKind kind, unsigned int seed) {
+    switch (kind) {
+        case AgentKind::TileCoding: return std::unique_ptr<Agent>(new AgentFor<TileCodingAgent>(seed));
+        case AgentKind::Linear: return std::unique_ptr<Agent>(new AgentFor<LinearAgent>(seed));
+        case AgentKind::Dqn: return std::unique_ptr<Agent>(new AgentFor<DqnAgent>(seed));
+        case AgentKind::QTable: break;
+    }
+    return std::unique_ptr<Agent>(new AgentFor<QLearningAgent>(seed));
+}
+
+const char* agent_kind_name(AgentKind kind) {
+    switch (kind) {
+        case AgentKind::QTable: return "table";
+        case AgentKind::TileCoding: return "tiles";
+        case AgentKind::Linear: return "linear";
+        case AgentKind::Dqn: return "dqn";
+    }
+    return "?";
+}
+
+bool parse_agent_kind(const std::string& name, AgentKind& kind) {
+    for (int k = 0; k < AGENT_KIND_COUNT; ++k) {
+        if (name == agent_kind_name(static_cast<AgentKind>(k))) {
+            kind = static_cast<AgentKind>(k);
+            return true;
+        }
+    }
+    return false;
+}
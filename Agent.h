@@ -0,0 +1,161 @@
+#ifndef PONG_AGENT_H
+#define PONG_AGENT_H
+
+#include "State.h"
+#include "QLearningAgent.h"
+#include "TileCodingAgent.h"
+#include "LinearAgent.h"
+#include "DqnAgent.h"
+#include <cstddef> // For size_t
+#include <memory>  // For std::unique_ptr
+#include <string>
+
+// Number of AgentKind values (they are numbered from 0 in declaration order).
+const int AGENT_KIND_COUNT = 4;
+
+// --- Static dispatch ---
+// AgentTraits<A> adapts one concrete agent type to the common vocabulary below: which half of an
+// AgentView it reads, and its own names for persistence and model size. Code templated on the
+// agent type (the training and evaluation loops) calls the agent and these directly, so
+// everything inlines and the hot loop makes no virtual calls.
+template <typename A>
+struct AgentTraits;
+
+template <>
+struct AgentTraits<QLearningAgent> {
+    typedef State Input;
+    static constexpr AgentKind kind = AgentKind::QTable;
+    static const char* file_name() { return "pong_q_table.dat"; }
+    static const State& input(const AgentView& view) { return view.state; }
+    static bool save(const QLearningAgent& agent, const std::string& filename) { return agent.save_q_table(filename); }
+    static bool load(QLearningAgent& agent, const std::string& filename) { return agent.load_q_table(filename); }
+    static size_t model_size(const QLearningAgent& agent) { return agent.get_explored_state_count(); }
+    static size_t model_bytes(const QLearningAgent& agent) { return agent.memory_bytes(); }
+};
+
+// The function-approximation agents read the Observation and save "weights"
+template <typename A>
+struct ObservationAgentTraits {
+    typedef Observation Input;
+    static const Observation& input(const AgentView& view) { return view.observation; }
+    static bool save(const A& agent, const std::string& filename) { return agent.save_weights(filename); }
+    static bool load(A& agent, const std::string& filename) { return agent.load_weights(filename); }
+    static size_t model_bytes(const A& agent) { return agent.memory_bytes(); }
+};
+
+template <>
+struct AgentTraits<TileCodingAgent> : ObservationAgentTraits<TileCodingAgent> {
+    static constexpr AgentKind kind = AgentKind::TileCoding;
+    static const char* file_name() { return "pong_tile_weights.dat"; }
+    static size_t model_size(const TileCodingAgent& agent) { return agent.get_active_tile_count(); }
+};
+
+template <>
+struct AgentTraits<LinearAgent> : ObservationAgentTraits<LinearAgent> {
+    static constexpr AgentKind kind = AgentKind::Linear;
+    static const char* file_name() { return "pong_linear_weights.dat"; }
+    static size_t model_size(const LinearAgent& agent) { return agent.get_weight_count(); }
+};
+
+template <>
+struct AgentTraits<DqnAgent> : ObservationAgentTraits<DqnAgent> {
+    static constexpr AgentKind kind = AgentKind::Dqn;
+    static const char* file_name() { return "pong_dqn_weights.dat"; }
+    static size_t model_size(const DqnAgent& agent) { return agent.get_parameter_count(); }
+};
+
+// --- Dynamic interface ---
+// Any agent that can play the CPU paddle, for code that picks the agent at run time (the game's
+// options menu, the tools' --agent flags). Each call is virtual; loops that run millions of steps
+// should go through visit_agent below instead.
+class Agent {
+public:
+    virtual ~Agent() {}
+
+    virtual AgentKind kind() const = 0;
+
+    // Epsilon-greedy action (may explore and advance the agent's random numbers).
+    virtual Action choose_action(const AgentView& view) = 0;
+    // Greedy action, no exploration.
+    virtual Action best_action(const AgentView& view) const = 0;
+    // Learns from one transition: `action` in `view` earned `reward` and led to `next_view`,
+    // whose value is weighted by `discount` (gamma for one step, see SemiMdp.h for longer ones).
+    virtual void observe(const AgentView& view, Action action, double reward, const AgentView& next_view,
+                         double discount) = 0;
+
+    virtual void set_difficulty(DifficultyLevel level) = 0;
+    virtual void set_parameters(double alpha, double gamma, double epsilon) = 0;
+    virtual double get_gamma() const = 0;
+    virtual long get_update_count() const = 0;
+
+    // States, tiles or weights learned, and the bytes they use.
+    virtual size_t model_size() const = 0;
+    virtual size_t memory_bytes() const = 0;
+
+    // Saves the learned values / loads them back. file_name() is where the game keeps them.
+    virtual bool save(const std::string& filename) const = 0;
+    virtual bool load(const std::string& filename) = 0;
+    virtual const char* file_name() const = 0;
+};
+
+// An Agent holding a concrete agent of type A.
+template <typename A>
+class AgentFor final : public Agent {
+private:
+    typedef AgentTraits<A> Traits;
+    A agent;
+
+public:
+    explicit AgentFor(unsigned int seed) : agent(seed) {}
+    explicit AgentFor(const A& initial) : agent(initial) {}
+
+    // The concrete agent, for type-specific settings and statically dispatched loops.
+    A& get() { return agent; }
+    const A& get() const { return agent; }
+
+    AgentKind kind() const override { return Traits::kind; }
+    Action choose_action(const AgentView& view) override { return agent.choose_action(Traits::input(view)); }
+    Action best_action(const AgentView& view) const override { return agent.best_action(Traits::input(view)); }
+    void observe(const AgentView& view, Action action, double reward, const AgentView& next_view,
+                 double discount) override {
+        agent.update_q_value(Traits::input(view), action, reward, Traits::input(next_view), discount);
+    }
+    void set_difficulty(DifficultyLevel level) override { agent.set_difficulty(level); }
+    void set_parameters(double alpha, double gamma, double epsilon) override { agent.set_parameters(alpha, gamma, epsilon); }
+    double get_gamma() const override { return agent.get_gamma(); }
+    long get_update_count() const override { return agent.get_update_count(); }
+    size_t model_size() const override { return Traits::model_size(agent); }
+    size_t memory_bytes() const override { return Traits::model_bytes(agent); }
+    bool save(const std::string& filename) const override { return Traits::save(agent, filename); }
+    bool load(const std::string& filename) override { return Traits::load(agent, filename); }
+    const char* file_name() const override { return Traits::file_name(); }
+};
+
+// A new agent of the given kind with a fixed random seed and the EASY parameters.
+std::unique_ptr<Agent> make_agent(AgentKind kind, unsigned int seed);
+
+// The concrete agent behind `agent`, which must be of type A (check kind() first).
+template <typename A>
+A& concrete_agent(Agent& agent) { return static_cast<AgentFor<A>&>(agent).get(); }
+template <typename A>
+const A& concrete_agent(const Agent& agent) { return static_cast<const AgentFor<A>&>(agent).get(); }
+
+// Calls `f` with the concrete agent behind `agent` and returns its result. One switch on the
+// kind, then `f` (usually a generic lambda) is compiled once per agent type and runs without
+// virtual calls.
+template <typename AgentRef, typename F>
+auto visit_agent(AgentRef& agent, F&& f) -> decltype(f(concrete_agent<QLearningAgent>(agent))) {
+    switch (agent.kind()) {
+        case AgentKind::TileCoding: return f(concrete_agent<TileCodingAgent>(agent));
+        case AgentKind::Linear: return f(concrete_agent<LinearAgent>(agent));
+        case AgentKind::Dqn: return f(concrete_agent<DqnAgent>(agent));
+        case AgentKind::QTable: break;
+    }
+    return f(concrete_agent<QLearningAgent>(agent));
+}
+
+// Short name of an agent kind ("table", "tiles", "linear", "dqn") and the reverse; false if unknown.
+const char* agent_kind_name(AgentKind kind);
+bool parse_agent_kind(const std::string& name, AgentKind& kind);
+
+#endif // PONG_AGENT_H
@@ -0,0 +1,66 @@
+#include "BakedPolicy.h"
+#include <cstdint> // For uint8_t
+#include <iostream>
+
+// Generated at build time by the BakePolicy tool
+#include "BakedPolicyData.inc"
+
+static_assert(BAKED_POLICY_STATE_COUNT == STATE_SPACE_SIZE,
+              "Baked policy was generated for a different discretization");
+
+// 2-bit code of a dense state index (0-2: action, 3: unseen)
+static constexpr int baked_code(size_t index) {
+    return (BAKED_POLICY_DATA[index / 4] >> ((index % 4) * 2)) & 0x3;
+}
+
+// Compares the states an unpacking found with the count BakePolicy wrote next to the data
+static void check_known_states(size_t found) {
+    if (found != BAKED_POLICY_KNOWN_STATES) {
+        std::cerr << "Error: Baked policy data holds " << found << " known states, but was generated with "
+                  << BAKED_POLICY_KNOWN_STATES << "." << std::endl;
+    }
+}
+
+// Is a policy baked in?
+bool has_baked_policy() {
+    return BAKED_POLICY_AVAILABLE;
+}
+
+// Unpack the baked policy
+GreedyPolicy baked_greedy_policy() {
+    GreedyPolicy policy(Action::STAY);
+    size_t known = 0;
+    for (size_t i = 0; i < BAKED_POLICY_STATE_COUNT; ++i) {
+        int code = baked_code(i);
+        if (code < NUM_ACTIONS) {
+            policy.set_action(i, static_cast<Action>(code));
+            known++;
+        }
+    }
+    check_known_states(known);
+    return policy;
+}
+
+// Seed an agent's Q-table from the baked policy
+size_t seed_agent_from_baked_policy(QLearningAgent& agent, double preference) {
+    size_t seeded = 0;
+    // Walk the dense index in the same mixed-radix order as state_index
+    State s;
+    size_t index = 0;
+    for (s.ball_x_grid = 0; s.ball_x_grid < GRID_X_DIVISIONS; ++s.ball_x_grid)
+    for (s.ball_y_grid = 0; s.ball_y_grid < GRID_Y_DIVISIONS; ++s.ball_y_grid)
+    for (s.ball_vx_category = -1; s.ball_vx_category <= 1; ++s.ball_vx_category)
+    for (s.ball_vy_category = -1; s.ball_vy_category <= 1; ++s.ball_vy_category)
+    for (s.cpu_paddle_y_grid = 0; s.cpu_paddle_y_grid < PADDLE_Y_DIVISIONS; ++s.cpu_paddle_y_grid)
+    for (s.player_paddle_y_grid = 0; s.player_paddle_y_grid < PADDLE_Y_DIVISIONS; ++s.player_paddle_y_grid) {
+        int code = baked_code(index++);
+        if (code < NUM_ACTIONS) {
+            QValues q_values{0.0, 0.0, 0.0};
+            q_values[code] = preference;
+            agent.set_q_values(encode_state(s), q_values);
+            seeded++;
+        }
+    }
+    check_known_states(seeded);
+    return seeded;
+}
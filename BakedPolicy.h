@@ -0,0 +1,22 @@
+#ifndef PONG_BAKEDPOLICY_H
+#define PONG_BAKEDPOLICY_H
+
+#include "QLearningAgent.h"
+#include "GreedyPolicy.h"
+#include <cstddef> // For size_t
+
+// Access to the policy baked into the executable at build time (see PONG_BAKED_Q_TABLE in
+// CMakeLists.txt). It is the fallback opponent when no Q-table file is found on disk.
+
+// True if this build contains a baked policy.
+bool has_baked_policy();
+
+// The baked policy as a GreedyPolicy (states it doesn't know play STAY).
+GreedyPolicy baked_greedy_policy();
+
+// Initializes the agent from the baked policy: every known state gets a Q-value of `preference`
+// for its baked action and 0 for the others, so the agent starts out playing the baked policy
+// and keeps learning from there. Returns the number of states seeded.
+size_t seed_agent_from_baked_policy(QLearningAgent& agent, double preference);
+
+#endif // PONG_BAKEDPOLICY_H
@@ -4,9 +4,10 @@
 #include <ctime>   // For seeding random
 
 // Constructor
-Ball::Ball(float startX, float startY, float ballRadius, float initialSpeed, const sf::Vector2u& bounds)
+Ball::Ball(float startX, float startY, float ballRadius, float initialSpeed, const sf::Vector2u& bounds,
+           unsigned int seed)
     : radius(ballRadius), speed(initialSpeed), windowBounds(bounds),
-      rng(std::random_device{}()), // Seed RNG
+      rng(seed), // Seed RNG
       angle_distribution(0, 3) // 4 initial directions (e.g., 45, 135, 225, 315 degrees)
 {
     shape.setRadius(radius);
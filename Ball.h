@@ -18,8 +18,9 @@ private:
     std::uniform_int_distribution<int> angle_distribution;
 
 public:
-    // Constructor
-    Ball(float startX, float startY, float ballRadius, float initialSpeed, const sf::Vector2u& bounds);
+    // Constructor. Pass a fixed seed for reproducible serve directions (e.g. headless training).
+    Ball(float startX, float startY, float ballRadius, float initialSpeed, const sf::Vector2u& bounds,
+         unsigned int seed = std::random_device{}());
 
     // Reset the ball to the center with a random initial direction
     void reset();
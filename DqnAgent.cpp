@@ -0,0 +1,350 @@
+#include "DqnAgent.h"
+#include <algorithm> // For std::max_element, std::copy, std::fill
+#include <cmath>     // For std::sqrt, std::pow
+#include <fstream>   // For file I/O
+#include <iostream>  // For error messages
+#include <iomanip>   // For std::setprecision
+
+// Adam hyperparameters (the usual defaults)
+static const float ADAM_BETA1 = 0.9f;
+static const float ADAM_BETA2 = 0.999f;
+static const float ADAM_EPSILON = 1e-8f;
+
+// Errors beyond this size get a constant gradient (Huber loss), so one surprising point
+// doesn't throw the weights around
+static const float HUBER_DELTA = 1.0f;
+
+// --- Kernels ---
+// Plain loops over compile-time sizes, shaped so the innermost loop is a contiguous
+// multiply-add the compiler vectorizes (like QLearningAgent::choose_actions).
+
+// out[n][o] = bias[o] + sum_i in[n][i] * w[i][o], then ReLU if requested, for n < count.
+// Sums go into a local array first: the compiler can't prove `out` doesn't overlap the weights,
+// and would otherwise store and reload every output after each input.
+template <int IN, int OUT, bool RELU>
+static void dense_forward(const float* in, size_t count, const float* w, const float* bias, float* out) {
+    for (size_t n = 0; n < count; ++n) {
+        const float* x = in + n * IN;
+        alignas(32) float y[OUT];
+        for (int o = 0; o < OUT; ++o) {
+            y[o] = bias[o];
+        }
+        for (int i = 0; i < IN; ++i) {
+            const float xi = x[i];
+            const float* wi = w + i * OUT;
+            for (int o = 0; o < OUT; ++o) {
+                y[o] += xi * wi[o];
+            }
+        }
+        for (int o = 0; o < OUT; ++o) {
+            out[n * OUT + o] = (RELU && y[o] < 0.0f) ? 0.0f : y[o];
+        }
+    }
+}
+
+// Dot product of two N-float vectors, accumulated in 8 independent lanes (vectorizes without
+// reordering a floating-point sum, see LinearAgent::q_values)
+template <int N>
+static float dot(const float* a, const float* b) {
+    float lanes[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < N; i += 8) {
+        for (int j = 0; j < 8; ++j) {
+            lanes[j] += a[i + j] * b[i + j];
+        }
+    }
+    return ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) + ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+}
+
+// Backward pass of one dense layer over `count` samples:
+//   grad_w[i][o] += in[n][i] * d_out[n][o],  grad_b[o] += d_out[n][o]
+// and, if `d_in` is given, d_in[n][i] = sum_o w[i][o] * d_out[n][o], masked by the ReLU that
+// produced `in` (in > 0).
+template <int IN, int OUT>
+static void dense_backward(const float* in, size_t count, const float* w, const float* d_out,
+                           float* grad_w, float* grad_b, float* d_in) {
+    for (size_t n = 0; n < count; ++n) {
+        const float* x = in + n * IN;
+        const float* d = d_out + n * OUT;
+        for (int o = 0; o < OUT; ++o) {
+            grad_b[o] += d[o];
+        }
+        for (int i = 0; i < IN; ++i) {
+            const float xi = x[i];
+            float* gi = grad_w + i * OUT;
+            for (int o = 0; o < OUT; ++o) {
+                gi[o] += xi * d[o];
+            }
+            if (d_in) {
+                d_in[n * IN + i] = (xi > 0.0f) ? dot<OUT>(w + i * OUT, d) : 0.0f;
+            }
+        }
+    }
+}
+
+// Constructor: He-uniform hidden weights, a small output layer, zero biases
+DqnAgent::DqnAgent(unsigned int seed)
+    : adam_step(0),
+      replay_next(0),
+      alpha(0.0003), gamma(0.9), epsilon(0.1), // Easy parameters
+      transition_count(0),
+      update_count(0),
+      rng(seed),
+      exploration_distribution(0.0, 1.0),
+      action_distribution(0, NUM_ACTIONS - 1)
+{
+    std::fill(online.p, online.p + DQN_PARAMETERS, 0.0f);
+    auto init = [this](size_t offset, int inputs, int outputs, int columns, float limit) {
+        std::uniform_real_distribution<float> weight(-limit, limit);
+        for (int i = 0; i < inputs; ++i) {
+            for (int o = 0; o < outputs; ++o) {
+                online.p[offset + i * columns + o] = weight(rng);
+            }
+        }
+    };
+    init(DQN_W1, DQN_INPUTS, DQN_HIDDEN, DQN_HIDDEN, std::sqrt(6.0f / DQN_INPUTS));
+    init(DQN_W2, DQN_HIDDEN, DQN_HIDDEN, DQN_HIDDEN, std::sqrt(6.0f / DQN_HIDDEN));
+    init(DQN_W3, DQN_HIDDEN, NUM_ACTIONS, DQN_OUTPUT_STRIDE, 0.1f * std::sqrt(3.0f / DQN_HIDDEN));
+    target = online;
+    std::fill(adam_m.p, adam_m.p + DQN_PARAMETERS, 0.0f);
+    std::fill(adam_v.p, adam_v.p + DQN_PARAMETERS, 0.0f);
+    replay.reserve(DQN_REPLAY_CAPACITY);
+}
+
+// Set difficulty parameters (gamma and epsilon as for the tabular agent)
+void DqnAgent::set_difficulty(DifficultyLevel level) {
+    switch (level) {
+        case DifficultyLevel::EASY:   set_parameters(0.0003, 0.9, 0.1); break;
+        case DifficultyLevel::MEDIUM: set_parameters(0.0003, 0.9, 0.2); break;
+        case DifficultyLevel::HARD:   set_parameters(0.0003, 0.95, 0.4); break;
+    }
+}
+
+// Set learning parameters directly
+void DqnAgent::set_parameters(double new_alpha, double new_gamma, double new_epsilon) {
+    alpha = new_alpha;
+    gamma = new_gamma;
+    epsilon = new_epsilon;
+}
+
+// Network inputs: positions centered on 0, the ball direction, and the ball's offset from the
+// CPU paddle now and at its predicted intercept
+void DqnAgent::encode(const Observation& o, float* input) {
+    input[0] = o.ball_x * 2.0f - 1.0f;
+    input[1] = o.ball_y * 2.0f - 1.0f;
+    input[2] = o.ball_vx;
+    input[3] = o.ball_vy;
+    input[4] = o.cpu_paddle_y * 2.0f - 1.0f;
+    input[5] = o.player_paddle_y * 2.0f - 1.0f;
+    input[6] = (o.ball_y - o.cpu_paddle_y) * 2.0f;
+    input[7] = (o.ball_intercept_y - o.cpu_paddle_y) * 2.0f;
+}
+
+// Forward pass for one block
+void DqnAgent::forward(const DqnParameters& net, const float* inputs, size_t count, float* q,
+                       float* h1, float* h2) {
+    alignas(32) float h1_local[DQN_BLOCK * DQN_HIDDEN];
+    alignas(32) float h2_local[DQN_BLOCK * DQN_HIDDEN];
+    if (!h1) h1 = h1_local;
+    if (!h2) h2 = h2_local;
+    dense_forward<DQN_INPUTS, DQN_HIDDEN, true>(inputs, count, net.p + DQN_W1, net.p + DQN_B1, h1);
+    dense_forward<DQN_HIDDEN, DQN_HIDDEN, true>(h1, count, net.p + DQN_W2, net.p + DQN_B2, h2);
+    dense_forward<DQN_HIDDEN, DQN_OUTPUT_STRIDE, false>(h2, count, net.p + DQN_W3, net.p + DQN_B3, q);
+}
+
+// Index of the largest of the first NUM_ACTIONS outputs (first maximum)
+static int best_output(const float* q) {
+    return static_cast<int>(std::max_element(q, q + NUM_ACTIONS) - q);
+}
+
+// Q-values of one observation
+QValues DqnAgent::get_q_values(const Observation& observation) const {
+    alignas(32) float input[DQN_INPUTS];
+    alignas(32) float q[DQN_OUTPUT_STRIDE];
+    encode(observation, input);
+    forward(online, input, 1, q);
+    return QValues{q[0], q[1], q[2]};
+}
+
+// Greedy action
+Action DqnAgent::best_action(const Observation& observation) const {
+    QValues q = get_q_values(observation);
+    return static_cast<Action>(std::max_element(q.begin(), q.end()) - q.begin());
+}
+
+// Choose an action using epsilon-greedy
+Action DqnAgent::choose_action(const Observation& observation) {
+    if (exploration_distribution(rng) < epsilon) {
+        return static_cast<Action>(action_distribution(rng)); // Explore
+    }
+    return best_action(observation);
+}
+
+// Greedy actions for many observations, one block at a time
+void DqnAgent::best_actions(const Observation* observations, size_t count, Action* actions) const {
+    alignas(32) float inputs[DQN_BLOCK * DQN_INPUTS];
+    alignas(32) float q[DQN_BLOCK * DQN_OUTPUT_STRIDE];
+    for (size_t start = 0; start < count; start += DQN_BLOCK) {
+        size_t block = std::min(DQN_BLOCK, count - start);
+        for (size_t n = 0; n < block; ++n) {
+            encode(observations[start + n], inputs + n * DQN_INPUTS);
+        }
+        forward(online, inputs, block, q);
+        for (size_t n = 0; n < block; ++n) {
+            actions[start + n] = static_cast<Action>(best_output(q + n * DQN_OUTPUT_STRIDE));
+        }
+    }
+}
+
+// Epsilon-greedy actions for many observations
+void DqnAgent::choose_actions(const Observation* observations, size_t count, Action* actions) {
+    best_actions(observations, count, actions);
+    // The greedy choices draw no random numbers, so drawing here in order reproduces the
+    // sequence of per-observation choose_action calls
+    for (size_t i = 0; i < count; ++i) {
+        if (exploration_distribution(rng) < epsilon) {
+            actions[i] = static_cast<Action>(action_distribution(rng));
+        }
+    }
+}
+
+// Store a transition (and train when due)
+void DqnAgent::update_q_value(const Observation& old_observation, Action action, double reward,
+                              const Observation& new_observation) {
+    update_q_value(old_observation, action, reward, new_observation, gamma);
+}
+
+// Store a transition with an explicit discount (and train when due)
+void DqnAgent::update_q_value(const Observation& old_observation, Action action, double reward,
+                              const Observation& new_observation, double discount) {
+    Experience experience;
+    encode(old_observation, experience.input);
+    encode(new_observation, experience.next_input);
+    experience.action = static_cast<int>(action);
+    experience.reward = static_cast<float>(reward);
+    experience.discount = static_cast<float>(discount);
+    if (replay.size() < DQN_REPLAY_CAPACITY) {
+        replay.push_back(experience);
+    } else {
+        replay[replay_next] = experience;
+        replay_next = (replay_next + 1) % DQN_REPLAY_CAPACITY;
+    }
+    transition_count++;
+
+    if (replay.size() >= DQN_WARMUP && transition_count % DQN_TRAIN_INTERVAL == 0) {
+        train_minibatch();
+    }
+}
+
+// One gradient step: Huber loss on Q(s, a) - (r + discount * max Q_target(s', .)), Adam update
+void DqnAgent::train_minibatch() {
+    static_assert(DQN_MINIBATCH <= DQN_BLOCK, "A minibatch must fit in one kernel block");
+
+    // --- Sample ---
+    alignas(32) float inputs[DQN_MINIBATCH * DQN_INPUTS];
+    alignas(32) float next_inputs[DQN_MINIBATCH * DQN_INPUTS];
+    const Experience* batch[DQN_MINIBATCH];
+    std::uniform_int_distribution<size_t> pick(0, replay.size() - 1);
+    for (size_t n = 0; n < DQN_MINIBATCH; ++n) {
+        batch[n] = &replay[pick(rng)];
+        std::copy(batch[n]->input, batch[n]->input + DQN_INPUTS, inputs + n * DQN_INPUTS);
+        std::copy(batch[n]->next_input, batch[n]->next_input + DQN_INPUTS, next_inputs + n * DQN_INPUTS);
+    }
+
+    // --- Targets from the target network ---
+    alignas(32) float next_q[DQN_MINIBATCH * DQN_OUTPUT_STRIDE];
+    forward(target, next_inputs, DQN_MINIBATCH, next_q);
+
+    // --- Forward (keeping activations) and output error ---
+    alignas(32) float h1[DQN_MINIBATCH * DQN_HIDDEN];
+    alignas(32) float h2[DQN_MINIBATCH * DQN_HIDDEN];
+    alignas(32) float q[DQN_MINIBATCH * DQN_OUTPUT_STRIDE];
+    forward(online, inputs, DQN_MINIBATCH, q, h1, h2);
+
+    alignas(32) float d_q[DQN_MINIBATCH * DQN_OUTPUT_STRIDE] = {};
+    for (size_t n = 0; n < DQN_MINIBATCH; ++n) {
+        const float* nq = next_q + n * DQN_OUTPUT_STRIDE;
+        float max_future_q = *std::max_element(nq, nq + NUM_ACTIONS);
+        float y = batch[n]->reward + batch[n]->discount * max_future_q;
+        float error = q[n * DQN_OUTPUT_STRIDE + batch[n]->action] - y;
+        error = std::max(-HUBER_DELTA, std::min(HUBER_DELTA, error)); // Huber gradient
+        d_q[n * DQN_OUTPUT_STRIDE + batch[n]->action] = error / DQN_MINIBATCH;
+    }
+
+    // --- Backward ---
+    DqnParameters grad;
+    std::fill(grad.p, grad.p + DQN_PARAMETERS, 0.0f);
+    alignas(32) float d_h2[DQN_MINIBATCH * DQN_HIDDEN];
+    alignas(32) float d_h1[DQN_MINIBATCH * DQN_HIDDEN];
+    dense_backward<DQN_HIDDEN, DQN_OUTPUT_STRIDE>(h2, DQN_MINIBATCH, online.p + DQN_W3, d_q,
+                                                  grad.p + DQN_W3, grad.p + DQN_B3, d_h2);
+    dense_backward<DQN_HIDDEN, DQN_HIDDEN>(h1, DQN_MINIBATCH, online.p + DQN_W2, d_h2,
+                                           grad.p + DQN_W2, grad.p + DQN_B2, d_h1);
+    dense_backward<DQN_INPUTS, DQN_HIDDEN>(inputs, DQN_MINIBATCH, online.p + DQN_W1, d_h1,
+                                           grad.p + DQN_W1, grad.p + DQN_B1, nullptr);
+
+    // --- Adam ---
+    adam_step++;
+    const float m_scale = 1.0f / (1.0f - static_cast<float>(std::pow(ADAM_BETA1, adam_step)));
+    const float v_scale = 1.0f / (1.0f - static_cast<float>(std::pow(ADAM_BETA2, adam_step)));
+    const float step = static_cast<float>(alpha);
+    for (size_t i = 0; i < DQN_PARAMETERS; ++i) {
+        float g = grad.p[i];
+        adam_m.p[i] = ADAM_BETA1 * adam_m.p[i] + (1.0f - ADAM_BETA1) * g;
+        adam_v.p[i] = ADAM_BETA2 * adam_v.p[i] + (1.0f - ADAM_BETA2) * g * g;
+        online.p[i] -= step * (adam_m.p[i] * m_scale) / (std::sqrt(adam_v.p[i] * v_scale) + ADAM_EPSILON);
+    }
+
+    update_count++;
+    if (update_count % DQN_TARGET_INTERVAL == 0) {
+        target = online;
+    }
+}
+
+// Save the online network: a header line, then the parameters, one layer per line
+bool DqnAgent::save_weights(const std::string& filename) const {
+    std::ofstream outfile(filename);
+    if (!outfile.is_open()) {
+        std::cerr << "Error: Could not open file for saving network weights: " << filename << std::endl;
+        return false;
+    }
+    outfile << "dqn " << DQN_INPUTS << " " << DQN_HIDDEN << " " << DQN_PARAMETERS << "\n";
+    outfile << std::setprecision(9); // Round-trips a float
+    const size_t layer_ends[] = {DQN_B1, DQN_W2, DQN_B2, DQN_W3, DQN_B3, DQN_PARAMETERS};
+    size_t i = 0;
+    for (size_t end : layer_ends) {
+        for (; i < end; ++i) {
+            outfile << online.p[i] << (i + 1 < end ? " " : "\n");
+        }
+    }
+    outfile.close();
+    std::cout << "Network weights saved to " << filename << std::endl;
+    return true;
+}
+
+// Load parameters saved by save_weights
+bool DqnAgent::load_weights(const std::string& filename) {
+    std::ifstream infile(filename);
+    if (!infile.is_open()) {
+        std::cerr << "Error: Could not open file for loading network weights: " << filename << std::endl;
+        return false;
+    }
+    std::string magic;
+    int inputs = 0;
+    int hidden = 0;
+    size_t parameters = 0;
+    if (!(infile >> magic >> inputs >> hidden >> parameters) || magic != "dqn" ||
+        inputs != DQN_INPUTS || hidden != DQN_HIDDEN || parameters != DQN_PARAMETERS) {
+        std::cerr << "Error: " << filename << " was saved with a different network shape." << std::endl;
+        return false;
+    }
+    DqnParameters loaded;
+    for (size_t i = 0; i < DQN_PARAMETERS; ++i) {
+        if (!(infile >> loaded.p[i])) {
+            std::cerr << "Error: " << filename << " is truncated." << std::endl;
+            return false;
+        }
+    }
+    online = loaded;
+    target = loaded;
+    return true;
+}
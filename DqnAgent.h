@@ -0,0 +1,154 @@
+#ifndef PONG_DQNAGENT_H
+#define PONG_DQNAGENT_H
+
+#include "State.h"
+#include "QLearningAgent.h" // For Action, QValues, DifficultyLevel
+#include <cstddef> // For size_t
+#include <random>
+#include <string>
+#include <vector>
+
+// --- Network shape ---
+// A small multilayer perceptron, DQN_INPUTS -> 64 -> 64 -> NUM_ACTIONS with ReLU hidden layers.
+// Every layer's weights are stored input-major (w[i * outputs + o]), so both the forward pass
+// and the weight gradients are runs of "vector += scalar * vector" over contiguous outputs, which
+// the compiler turns into SIMD multiply-adds. Sizes are multiples of 8 floats (one 32-byte
+// vector); the output layer is padded from 3 to 8 columns for the same reason.
+const int DQN_INPUTS = 8;
+const int DQN_HIDDEN = 64;
+const int DQN_OUTPUT_STRIDE = 8; // NUM_ACTIONS outputs, padded
+
+// Offsets of each layer's parameters in the flat parameter array (all 32-byte aligned)
+const size_t DQN_W1 = 0;
+const size_t DQN_B1 = DQN_W1 + DQN_INPUTS * DQN_HIDDEN;
+const size_t DQN_W2 = DQN_B1 + DQN_HIDDEN;
+const size_t DQN_B2 = DQN_W2 + DQN_HIDDEN * DQN_HIDDEN;
+const size_t DQN_W3 = DQN_B2 + DQN_HIDDEN;
+const size_t DQN_B3 = DQN_W3 + DQN_HIDDEN * DQN_OUTPUT_STRIDE;
+const size_t DQN_PARAMETERS = DQN_B3 + DQN_OUTPUT_STRIDE; // 5256 floats, ~21 KB
+
+// Samples processed together by the batched kernels: one block's activations (32 x 64 floats,
+// 8 KB per layer) stay in L1 while a layer's weights are streamed over them.
+const size_t DQN_BLOCK = 32;
+
+// Replay and training schedule
+const size_t DQN_REPLAY_CAPACITY = 50000; // Transitions kept (oldest overwritten)
+const size_t DQN_MINIBATCH = 32;          // Transitions per gradient step
+const size_t DQN_WARMUP = 1000;           // Transitions collected before the first gradient step
+const long DQN_TRAIN_INTERVAL = 4;        // Transitions per gradient step
+const long DQN_TARGET_INTERVAL = 500;     // Gradient steps between target network refreshes
+
+// The network's parameters (the online network, its target copy, and Adam's moment estimates
+// each hold one). 32-byte aligned so every layer starts on a vector boundary.
+struct alignas(32) DqnParameters {
+    float p[DQN_PARAMETERS];
+};
+
+// Deep Q-learning with a small MLP, entirely on the CPU:
+//   - experience replay: update_q_value stores the transition, and every DQN_TRAIN_INTERVAL
+//     transitions one minibatch sampled from the buffer is trained on (Huber loss, Adam);
+//   - a target network, refreshed every DQN_TARGET_INTERVAL gradient steps, provides
+//     max Q(s', .) for the targets;
+//   - batched inference (best_actions / choose_actions) runs thousands of observations per
+//     call through the same blocked kernels.
+// The networks and optimizer state take ~80 KB (well inside L2); the replay buffer ~4 MB.
+//
+// Same choose/update interface as the other agents. Here alpha is Adam's step size, so sensible
+// values are around 0.0003 rather than the tabular agents' 0.1.
+class DqnAgent {
+private:
+    // One stored transition, with the network inputs already computed.
+    struct Experience {
+        float input[DQN_INPUTS];
+        float next_input[DQN_INPUTS];
+        int action;
+        float reward;
+        float discount;
+    };
+
+    DqnParameters online;
+    DqnParameters target;
+    DqnParameters adam_m; // First moment
+    DqnParameters adam_v; // Second moment
+    long adam_step;
+
+    std::vector<Experience> replay;
+    size_t replay_next; // Slot the next transition overwrites once the buffer is full
+
+    double alpha;   // Adam step size
+    double gamma;
+    double epsilon;
+
+    long transition_count; // Transitions stored so far
+    long update_count;     // Gradient steps so far
+
+    mutable std::mt19937 rng;
+    std::uniform_real_distribution<double> exploration_distribution;
+    std::uniform_int_distribution<int> action_distribution;
+
+    // Network inputs for an observation.
+    static void encode(const Observation& observation, float* input);
+
+    // Q-values of `count` (<= DQN_BLOCK) inputs, DQN_OUTPUT_STRIDE floats per sample.
+    // If `h1`/`h2` are given, the hidden activations are kept for the backward pass.
+    static void forward(const DqnParameters& net, const float* inputs, size_t count, float* q,
+                        float* h1 = nullptr, float* h2 = nullptr);
+
+    // One gradient step on a minibatch sampled from the replay buffer.
+    void train_minibatch();
+
+public:
+    // Constructor with a fixed random seed (initial weights and exploration).
+    explicit DqnAgent(unsigned int seed = std::random_device{}());
+
+    // Same gamma and epsilon as QLearningAgent::set_difficulty; Adam step size 0.0003 (silently).
+    void set_difficulty(DifficultyLevel level);
+
+    // Sets alpha (Adam step size), gamma and epsilon directly.
+    void set_parameters(double new_alpha, double new_gamma, double new_epsilon);
+
+    // Re-seeds the exploration and replay-sampling random number generator.
+    void seed(unsigned int seed) { rng.seed(seed); }
+
+    // Epsilon-greedy action for an observation.
+    Action choose_action(const Observation& observation);
+
+    // Greedy action (first maximum on ties).
+    Action best_action(const Observation& observation) const;
+
+    // Q-values of all actions for an observation.
+    QValues get_q_values(const Observation& observation) const;
+
+    // --- Batched inference ---
+    // Greedy actions for `count` observations, DQN_BLOCK at a time.
+    void best_actions(const Observation* observations, size_t count, Action* actions) const;
+    // Epsilon-greedy actions; same choices (and random number sequence) as calling
+    // choose_action for each observation in order.
+    void choose_actions(const Observation* observations, size_t count, Action* actions);
+
+    // Stores the transition in the replay buffer and trains on a minibatch when one is due.
+    void update_q_value(const Observation& old_observation, Action action, double reward,
+                        const Observation& new_observation);
+
+    // Same with an explicit discount instead of gamma (see SemiMdp.h).
+    void update_q_value(const Observation& old_observation, Action action, double reward,
+                        const Observation& new_observation, double discount);
+
+    // Saves the online network's parameters to a text file / loads them back (into both networks).
+    bool save_weights(const std::string& filename) const;
+    bool load_weights(const std::string& filename);
+
+    double get_alpha() const { return alpha; }
+    double get_gamma() const { return gamma; }
+    double get_epsilon() const { return epsilon; }
+
+    // Number of gradient steps since construction.
+    long get_update_count() const { return update_count; }
+
+    // Number of network parameters, and the bytes of the networks and optimizer state
+    // (the replay buffer not included).
+    size_t get_parameter_count() const { return DQN_PARAMETERS; }
+    size_t memory_bytes() const { return 4 * sizeof(DqnParameters); }
+};
+
+#endif // PONG_DQNAGENT_H
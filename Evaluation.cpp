@@ -0,0 +1,167 @@
+#include "Evaluation.h"
+#include "Simulation.h"
+#include "ScriptedOpponent.h"
+#include "ThreadPool.h"
+#include <algorithm> // For std::min
+#include <cmath>     // For std::sqrt
+#include <cstdint>   // For uint64_t
+#include <future>
+
+// z for a two-sided 95% interval
+static const double Z_95 = 1.959964;
+
+// Upper bound on steps per point, in case both paddles keep returning forever
+static const long MAX_STEPS_PER_POINT = 20000;
+
+// Seed of match `index`: a splitmix64 step, so neighbouring matches get unrelated seeds
+static unsigned int match_seed(unsigned int seed, long index) {
+    std::uint64_t z = (static_cast<std::uint64_t>(seed) << 32) + static_cast<std::uint64_t>(index) + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<unsigned int>(z ^ (z >> 31));
+}
+
+// Wilson score interval for `successes` out of `trials`
+static Estimate wilson_interval(long successes, long trials) {
+    Estimate estimate;
+    if (trials == 0) return estimate;
+    double n = static_cast<double>(trials);
+    double p = successes / n;
+    double z2 = Z_95 * Z_95;
+    double center = (p + z2 / (2.0 * n)) / (1.0 + z2 / n);
+    double half_width = Z_95 * std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / (1.0 + z2 / n);
+    estimate.mean = p;
+    estimate.low = center - half_width;
+    estimate.high = center + half_width;
+    return estimate;
+}
+
+// Normal-approximation interval for the mean of `values`
+static Estimate mean_interval(const std::vector<double>& values) {
+    Estimate estimate;
+    if (values.empty()) return estimate;
+    double n = static_cast<double>(values.size());
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    double mean = sum / n;
+    double squares = 0.0;
+    for (double v : values) squares += (v - mean) * (v - mean);
+    double half_width = values.size() > 1 ? Z_95 * std::sqrt(squares / (n - 1.0) / n) : 0.0;
+    estimate.mean = mean;
+    estimate.low = mean - half_width;
+    estimate.high = mean + half_width;
+    return estimate;
+}
+
+// The right paddle's greedy action: a compiled policy looks up the State, an agent reads
+// whichever view it uses
+static Action greedy_action(const GreedyPolicy& policy, const Simulation& world) {
+    return policy.choose_action(world.getRightState());
+}
+
+template <typename A>
+static Action greedy_action(const A& agent, const Simulation& world) {
+    return agent.best_action(world.getRightInput<typename AgentTraits<A>::Input>());
+}
+
+// One match, `policy` (a GreedyPolicy or a concrete agent, playing greedily) on the right
+template <typename Policy>
+static MatchResult play_match_with(const Policy& policy, float opponent_skill, unsigned int seed,
+                                   int points_to_win, float dt) {
+    MatchResult result;
+    Simulation world(seed);
+    ScriptedOpponent opponent(opponent_skill, seed ^ 0x5bd1e995u);
+    long step_budget = MAX_STEPS_PER_POINT * (2L * points_to_win - 1);
+    while (result.points_won < points_to_win && result.points_lost < points_to_win &&
+           result.steps < step_budget) {
+        Action action = greedy_action(policy, world);
+        StepEvents events = world.step(dt, opponent.chooseAction(world, true), action);
+        result.steps++;
+        result.returns += events.leftHit + events.rightHit;
+        if (events.scoreEvent == -1) result.points_won++;  // Right paddle scored
+        if (events.scoreEvent == 1) result.points_lost++;  // Left paddle scored
+    }
+    result.won = (result.points_won > result.points_lost);
+    return result;
+}
+
+MatchResult play_match(const GreedyPolicy& policy, float opponent_skill, unsigned int seed,
+                       int points_to_win, float dt) {
+    return play_match_with(policy, opponent_skill, seed, points_to_win, dt);
+}
+
+MatchResult play_match(const Agent& agent, float opponent_skill, unsigned int seed,
+                       int points_to_win, float dt) {
+    return visit_agent(agent, [&](const auto& concrete) {
+        return play_match_with(concrete, opponent_skill, seed, points_to_win, dt);
+    });
+}
+
+// Batched parallel evaluation with early stopping
+template <typename Policy>
+static EvaluationSummary evaluate_with(const Policy& policy, const EvaluationConfig& config) {
+    EvaluationSummary summary;
+    size_t opponent_count = config.opponent_skills.size();
+    if (opponent_count == 0 || config.max_matches <= 0) return summary;
+
+    std::vector<MatchResult> results;
+    ThreadPool pool(config.threads);
+    size_t batch_size = std::max<size_t>(1, config.batch_size);
+    while (static_cast<long>(results.size()) < config.max_matches) {
+        // Play the next batch; each match writes only its own slot
+        long first = static_cast<long>(results.size());
+        long count = std::min<long>(static_cast<long>(batch_size), config.max_matches - first);
+        results.resize(first + count);
+        std::vector<std::future<void>> pending;
+        for (long i = first; i < first + count; ++i) {
+            pending.push_back(pool.submit([&, i] {
+                float skill = config.opponent_skills[static_cast<size_t>(i) % opponent_count];
+                results[i] = play_match_with(policy, skill, match_seed(config.seed, i), config.points_to_win, config.dt);
+            }));
+        }
+        for (std::future<void>& f : pending) f.get();
+
+        // Stopping rule, evaluated only on whole batches
+        long wins = 0;
+        for (const MatchResult& r : results) wins += r.won;
+        Estimate win_rate = wilson_interval(wins, static_cast<long>(results.size()));
+        if (static_cast<long>(results.size()) >= config.min_matches &&
+            (win_rate.high - win_rate.low) / 2.0 <= config.target_half_width) {
+            summary.stopped_early = static_cast<long>(results.size()) < config.max_matches;
+            break;
+        }
+    }
+
+    // Aggregate in match order
+    long wins = 0;
+    std::vector<double> rally_lengths, points_won, points_lost;
+    std::vector<long> wins_by_opponent(opponent_count, 0);
+    summary.matches_by_opponent.assign(opponent_count, 0);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const MatchResult& r = results[i];
+        int points = r.points_won + r.points_lost;
+        wins += r.won;
+        rally_lengths.push_back(points > 0 ? static_cast<double>(r.returns) / points : 0.0);
+        points_won.push_back(r.points_won);
+        points_lost.push_back(r.points_lost);
+        wins_by_opponent[i % opponent_count] += r.won;
+        summary.matches_by_opponent[i % opponent_count]++;
+    }
+    summary.matches = static_cast<long>(results.size());
+    summary.win_rate = wilson_interval(wins, summary.matches);
+    summary.rally_length = mean_interval(rally_lengths);
+    summary.points_won = mean_interval(points_won);
+    summary.points_lost = mean_interval(points_lost);
+    for (size_t k = 0; k < opponent_count; ++k) {
+        summary.win_rate_by_opponent.push_back(wilson_interval(wins_by_opponent[k], summary.matches_by_opponent[k]));
+    }
+    return summary;
+}
+
+EvaluationSummary evaluate_policy(const GreedyPolicy& policy, const EvaluationConfig& config) {
+    return evaluate_with(policy, config);
+}
+
+EvaluationSummary evaluate_agent(const Agent& agent, const EvaluationConfig& config) {
+    return visit_agent(agent, [&config](const auto& concrete) { return evaluate_with(concrete, config); });
+}
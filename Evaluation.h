@@ -0,0 +1,65 @@
+#ifndef PONG_EVALUATION_H
+#define PONG_EVALUATION_H
+
+#include "GreedyPolicy.h"
+#include "Agent.h"
+#include <cstddef> // For size_t
+#include <vector>
+
+// Settings for evaluating a policy against the scripted opponents.
+struct EvaluationConfig {
+    long max_matches = 2000;          // Stop after this many matches at the latest
+    long min_matches = 100;           // Don't stop early before this many
+    double target_half_width = 0.02;  // Stop once the 95% win-rate interval is this tight
+    int points_to_win = 10;           // Match length (the game plays to 10)
+    std::vector<float> opponent_skills{0.3f, 0.5f, 0.7f}; // Match i faces skill i % count
+    size_t threads = 0;               // Worker threads (0 = one per hardware thread)
+    size_t batch_size = 64;           // Matches between stopping checks
+    unsigned int seed = 1;
+    float dt = 1.0f / 60.0f;          // Seconds per step
+};
+
+// Outcome of one match, from the evaluated policy's side.
+struct MatchResult {
+    bool won = false;
+    int points_won = 0;
+    int points_lost = 0;
+    long returns = 0; // Paddle hits by both sides
+    long steps = 0;
+};
+
+// A mean with its 95% confidence interval.
+struct Estimate {
+    double mean = 0.0;
+    double low = 0.0;
+    double high = 0.0;
+};
+
+struct EvaluationSummary {
+    long matches = 0;
+    bool stopped_early = false;  // The win-rate interval reached the target before max_matches
+    Estimate win_rate;           // Wilson score interval
+    Estimate rally_length;       // Returns per point, averaged per match
+    Estimate points_won;         // Per match
+    Estimate points_lost;        // Per match
+    std::vector<Estimate> win_rate_by_opponent; // One per opponent skill
+    std::vector<long> matches_by_opponent;
+};
+
+// Plays one headless match of `policy` (right paddle, no learning) against a ScriptedOpponent.
+// Fully determined by its arguments.
+MatchResult play_match(const GreedyPolicy& policy, float opponent_skill, unsigned int seed,
+                       int points_to_win, float dt);
+// Same with any agent playing greedily (Agent::best_action); the agent is not modified.
+MatchResult play_match(const Agent& agent, float opponent_skill, unsigned int seed,
+                       int points_to_win, float dt);
+
+// Plays seeded matches in parallel batches until the win-rate interval is tight enough or
+// max_matches is reached. Match i always gets the same seed and opponent, and stopping is only
+// decided between batches, so the summary depends only on the config, never on the thread count.
+EvaluationSummary evaluate_policy(const GreedyPolicy& policy, const EvaluationConfig& config);
+// Same for any agent. The matches share it read-only (best_action is const and side-effect free
+// for every agent type), and each runs statically dispatched on the agent's concrete type.
+EvaluationSummary evaluate_agent(const Agent& agent, const EvaluationConfig& config);
+
+#endif // PONG_EVALUATION_H
@@ -1,17 +1,16 @@
 #include "Game.h"
+#include "BakedPolicy.h"
+#include "GameConstants.h"
 #include <iostream> // For debug output
-#include <cmath>    // For std::abs, std::floor
+#include <cmath>    // For std::abs, std::floor, std::pow
+#include <fstream>  // For checking for saved models
 #include <string>   // For std::to_string
 
-// --- Constants ---
-const unsigned int WINDOW_WIDTH = 800;
-const unsigned int WINDOW_HEIGHT = 600;
-const float PADDLE_WIDTH = 15.0f;
-const float PADDLE_HEIGHT = 80.0f;
-const float BALL_RADIUS = 8.0f;
-const float PADDLE_SPEED = 400.0f; // Pixels per second
-const float BALL_INITIAL_SPEED = 300.0f; // Pixels per second
-const float PADDLE_MARGIN = 20.0f; // Distance from edge
+// True if `path` can be opened. A missing save file just means there is nothing to load yet, so
+// the game checks first instead of letting the loaders report it as an error.
+static bool savedFileExists(const std::string& path) {
+    return std::ifstream(path).good();
+}
 
 // Constructor
 Game::Game()
@@ -20,8 +19,16 @@ Game::Game()
       currentState(GameState::MainMenu), // Start at the main menu
       playerScore(startingScore),
       cpuScore(startingScore),
-      aiStateInitialized(false),
-      currentDifficulty(DifficultyLevel::EASY) // Default difficulty
+      aiAgentKind(AgentKind::QTable),
+      aiStateValid(false),
+      aiAction(Action::STAY),
+      aiDecisionSeconds(0.0f),
+      currentDifficulty(DifficultyLevel::EASY), // Default difficulty
+      aiLearningEnabled(true), // Learn while playing by default
+      aiSemiMdp(false), // One Q-update per decision by default
+      aiPlanning(false),
+      scheduler(schedule_for_difficulty(DifficultyLevel::EASY)),
+      frameSeconds(0.0f) // No deadline (so no planning) until a frame has been measured
 {
     window.setVerticalSyncEnabled(true); // Helps prevent screen tearing
     // Optional: Limit framerate if vsync is off or unreliable
@@ -35,35 +42,34 @@ Game::Game()
         }
     }
 
-    // --- Initialize Game Objects ---
-    playerPaddle = std::make_unique<Paddle>(
-        PADDLE_MARGIN,                          // x position (left side)
-        windowSize.y / 2.0f - PADDLE_HEIGHT / 2.0f, // y position (centered)
-        PADDLE_WIDTH, PADDLE_HEIGHT, PADDLE_SPEED, windowSize
-    );
-
-    cpuPaddle = std::make_unique<Paddle>(
-        windowSize.x - PADDLE_WIDTH - PADDLE_MARGIN, // x position (right side)
-        windowSize.y / 2.0f - PADDLE_HEIGHT / 2.0f,  // y position (centered)
-        PADDLE_WIDTH, PADDLE_HEIGHT, PADDLE_SPEED, windowSize // AI speed might be adjusted later
-    );
-
-    ball = std::make_unique<Ball>(
-        windowSize.x / 2.0f, windowSize.y / 2.0f, // Center position
-        BALL_RADIUS, BALL_INITIAL_SPEED, windowSize
-    );
-
     // --- Setup UI Elements ---
     setupText();
     setupMenus();
 
     // --- AI Setup ---
-    aiAgent.set_difficulty(currentDifficulty);
-    // Optional: Try loading a pre-trained Q-table
-    if (!aiAgent.load_q_table("pong_q_table.dat")) {
-         std::cout << "No pre-trained Q-table found or error loading. Starting fresh." << std::endl;
+    for (int kind = 0; kind < AGENT_KIND_COUNT; ++kind) {
+        aiAgents.push_back(make_agent(static_cast<AgentKind>(kind), std::random_device{}()));
+        aiAgents.back()->set_difficulty(currentDifficulty);
+    }
+    // Optional: Try loading a pre-trained Q-table, falling back to the policy baked into the build
+    Agent& tableAi = *aiAgents[static_cast<int>(AgentKind::QTable)];
+    if (!savedFileExists(tableAi.file_name()) || !tableAi.load(tableAi.file_name())) {
+         if (has_baked_policy()) {
+              size_t seeded = seed_agent_from_baked_policy(tableAgent(), 1.0);
+              aiPolicy = baked_greedy_policy();
+              std::cout << "No Q-table file found. Starting from the built-in policy (" << seeded << " states)." << std::endl;
+         } else {
+              std::cout << "No pre-trained Q-table found or error loading. Starting fresh." << std::endl;
+         }
     } else {
-         std::cout << "Loaded Q-table with " << aiAgent.get_explored_state_count() << " states." << std::endl;
+         std::cout << "Loaded Q-table with " << tableAgent().get_explored_state_count() << " states." << std::endl;
+    }
+    // The function-approximation agents start from their saved weights if there are any
+    for (const std::unique_ptr<Agent>& agent : aiAgents) {
+        if (agent->kind() != AgentKind::QTable && savedFileExists(agent->file_name()) &&
+            agent->load(agent->file_name())) {
+             std::cout << "Loaded " << agent_kind_name(agent->kind()) << " agent from " << agent->file_name() << "." << std::endl;
+        }
     }
 }
 
@@ -97,7 +103,7 @@ void Game::setupMenus() {
                                       "PONG AI");
 
     optionsMenu = std::make_unique<Menu>(windowSize.x, windowSize.y,
-                                         std::vector<std::string>{"Difficulty: Easy", "Back"}, // Text updated dynamically
+                                         std::vector<std::string>{"Difficulty: Easy", "Learning: On", "Updates: Every decision", "Planning: Off", "Agent: Q-table", "Back"}, // Text updated dynamically
                                          "Options");
 
     pauseMenu = std::make_unique<Menu>(windowSize.x, windowSize.y,
@@ -109,6 +115,29 @@ void Game::setupMenus() {
                                           "Game Over"); // Title set dynamically later
 }
 
+// Update the options menu text based on current settings
+void Game::updateOptionsMenuText() {
+    std::string diffText = "Difficulty: ";
+    switch(currentDifficulty) {
+        case DifficultyLevel::EASY: diffText += "Easy"; break;
+        case DifficultyLevel::MEDIUM: diffText += "Medium"; break;
+        case DifficultyLevel::HARD: diffText += "Hard"; break;
+    }
+    optionsMenu->setItemText(0, diffText);
+    optionsMenu->setItemText(1, aiLearningEnabled ? "Learning: On" : "Learning: Off");
+    if (aiSemiMdp && aiAgentKind != AgentKind::QTable) {
+        optionsMenu->setItemText(2, "Updates: On state change (Q-table only)"); // Not used by this agent
+    } else {
+        optionsMenu->setItemText(2, aiSemiMdp ? "Updates: On state change" : "Updates: Every decision");
+    }
+    optionsMenu->setItemText(3, aiPlanning ? "Planning: On" : "Planning: Off");
+    switch (aiAgentKind) {
+        case AgentKind::QTable: optionsMenu->setItemText(4, "Agent: Q-table"); break;
+        case AgentKind::TileCoding: optionsMenu->setItemText(4, "Agent: Tile coding"); break;
+        case AgentKind::Linear: optionsMenu->setItemText(4, "Agent: Linear"); break;
+        case AgentKind::Dqn: optionsMenu->setItemText(4, "Agent: Neural network"); break;
+    }
+}
 
 // Update score display strings
 void Game::updateScoreDisplay() {
@@ -130,29 +159,51 @@ void Game::resetGame() {
     playerScore = startingScore;
     cpuScore = startingScore;
     updateScoreDisplay();
-    playerPaddle->setPosition(PADDLE_MARGIN, windowSize.y / 2.0f - PADDLE_HEIGHT / 2.0f);
-    cpuPaddle->setPosition(windowSize.x - PADDLE_WIDTH - PADDLE_MARGIN, windowSize.y / 2.0f - PADDLE_HEIGHT / 2.0f);
-    ball->reset();
-    aiStateInitialized = false; // Reset AI state tracking
+    world.reset(); // Center paddles and serve a new ball
+    aiStateValid = false; // The field changed outside a step: recompute the AI state
+    applyAiExperience(); // Queued decisions belong to the game that made them
+    aiTransition.discard();
+    tableAgent().end_transition(); // The planning model must not link the old game to the new one
+    tableAgent().reset_action_cache_stats(); // printAiStats reports per game
+    scheduler.reset(); // Decide on the first step of the new game
     currentState = GameState::Playing; // Go directly to playing state after reset
 }
 
 // Main game loop
 void Game::run() {
-    sf::Clock clock; // Clock to measure delta time
     while (window.isOpen()) {
-        sf::Time dt = clock.restart(); // Time elapsed since last frame
+        sf::Time dt = frameClock.restart(); // Time elapsed since last frame
+        measureFramePeriod(dt);
         processEvents();
         update(dt);
         render();
     }
 
     // Optional: Save the learned Q-table when the game closes
-    if (aiAgent.save_q_table("pong_q_table.dat")) {
+    applyAiExperience();
+    if (tableAgent().save_q_table("pong_q_table.dat")) {
          std::cout << "Q-table saved successfully on exit." << std::endl;
     } else {
          std::cerr << "Failed to save Q-table on exit." << std::endl;
     }
+    // The other agents only if they have learned something this session
+    for (const std::unique_ptr<Agent>& agent : aiAgents) {
+        if (agent->kind() != AgentKind::QTable && agent->get_update_count() > 0 && !agent->save(agent->file_name())) {
+             std::cerr << "Failed to save the " << agent_kind_name(agent->kind()) << " agent on exit." << std::endl;
+        }
+    }
+}
+
+// Track the display's refresh period from the frame times. With vsync a frame lasts one period,
+// or a whole number of them when it misses one, so the estimate follows the shortest recent frame
+// at once and only drifts up slowly (for a slower display), ignoring the odd missed vsync
+void Game::measureFramePeriod(sf::Time dt) {
+    float seconds = dt.asSeconds();
+    if (frameSeconds <= 0.0f || seconds < frameSeconds) {
+        frameSeconds = seconds;
+    } else {
+        frameSeconds += (seconds - frameSeconds) * 0.01f;
+    }
 }
 
 // Event handling
@@ -224,14 +275,7 @@ void Game::handleMenuInput(sf::Keyboard::Key key) {
                 currentState = GameState::Playing;
             } else if (selectedIndex == 1) { // Options
                 currentState = GameState::OptionsMenu;
-                // Update options menu text based on current settings
-                 std::string diffText = "Difficulty: ";
-                 switch(currentDifficulty) {
-                     case DifficultyLevel::EASY: diffText += "Easy"; break;
-                     case DifficultyLevel::MEDIUM: diffText += "Medium"; break;
-                     case DifficultyLevel::HARD: diffText += "Hard"; break;
-                 }
-                 optionsMenu->setItemText(0, diffText);
+                updateOptionsMenuText(); // Update options menu text based on current settings
 
             } else if (selectedIndex == 2) { // Exit
                 window.close();
@@ -242,18 +286,54 @@ void Game::handleMenuInput(sf::Keyboard::Key key) {
                 if (currentDifficulty == DifficultyLevel::EASY) currentDifficulty = DifficultyLevel::MEDIUM;
                 else if (currentDifficulty == DifficultyLevel::MEDIUM) currentDifficulty = DifficultyLevel::HARD;
                 else currentDifficulty = DifficultyLevel::EASY;
-                aiAgent.set_difficulty(currentDifficulty); // Apply to agent
-
-                // Update menu text
-                 std::string diffText = "Difficulty: ";
-                 switch(currentDifficulty) {
-                     case DifficultyLevel::EASY: diffText += "Easy"; break;
-                     case DifficultyLevel::MEDIUM: diffText += "Medium"; break;
-                     case DifficultyLevel::HARD: diffText += "Hard"; break;
-                 }
-                 optionsMenu->setItemText(0, diffText);
-
-            } else if (selectedIndex == 1) { // Back
+                for (const std::unique_ptr<Agent>& agent : aiAgents) {
+                    agent->set_difficulty(currentDifficulty); // Apply to the agents
+                }
+                scheduler.set_rates(schedule_for_difficulty(currentDifficulty)); // And its reaction time
+                updateOptionsMenuText();
+
+            } else if (selectedIndex == 1) { // Learning On/Off
+                aiLearningEnabled = !aiLearningEnabled;
+                if (!aiLearningEnabled) {
+                    applyAiExperience(); // Learn from the decisions still queued first
+                    // Freeze the AI: compile the Q-table into a one-byte-per-state greedy policy
+                    aiPolicy = GreedyPolicy::compile(tableAgent());
+                    std::cout << "AI learning off: playing the compiled greedy policy ("
+                              << tableAgent().get_explored_state_count() << " known states)" << std::endl;
+                } else {
+                    std::cout << "AI learning on." << std::endl;
+                }
+                aiTransition.discard(); // Don't learn from a transition that spans the switch
+                tableAgent().end_transition(); // Nor record one for planning
+                updateOptionsMenuText();
+
+            } else if (selectedIndex == 2) { // Update mode: every frame / semi-MDP
+                aiSemiMdp = !aiSemiMdp;
+                applyAiExperience(); // Queued decisions are learned in the mode that queued them
+                aiTransition.discard();
+                tableAgent().end_transition();
+                std::cout << (aiSemiMdp ? "AI updates once per change of discretized state."
+                                        : "AI updates once per decision.") << std::endl;
+                warnIfSemiMdpIgnored();
+                updateOptionsMenuText();
+
+            } else if (selectedIndex == 3) { // Planning (Dyna-Q) on/off
+                aiPlanning = !aiPlanning;
+                // Record transitions only; the game plans in its own time, once per frame
+                tableAgent().set_dyna_planning(aiPlanning);
+                std::cout << (aiPlanning ? "AI planning on: replaying recorded transitions between frames."
+                                         : "AI planning off.") << std::endl;
+                updateOptionsMenuText();
+
+            } else if (selectedIndex == 4) { // Agent: Q-table / tile coding / linear / neural network
+                applyAiExperience(); // Queued decisions belong to the agent that made them
+                aiTransition.discard();
+                tableAgent().end_transition();
+                aiAgentKind = static_cast<AgentKind>((static_cast<int>(aiAgentKind) + 1) % AGENT_KIND_COUNT);
+                warnIfSemiMdpIgnored();
+                updateOptionsMenuText();
+
+            } else if (selectedIndex == 5) { // Back
                 currentState = GameState::MainMenu;
             }
         } else if (currentState == GameState::Paused) {
@@ -303,30 +383,92 @@ void Game::update(sf::Time dt) {
 }
 
 // Update logic for the Playing state
+// Physics runs in fixed steps at the scheduler's rate (several per frame at 240 Hz); the AI
+// decides every few steps and holds its action in between.
 void Game::updatePlaying(sf::Time dt) {
-    float seconds = dt.asSeconds();
+    // --- Player Input ---
+    bool upPressed = sf::Keyboard::isKeyPressed(sf::Keyboard::W);
+    bool downPressed = sf::Keyboard::isKeyPressed(sf::Keyboard::S);
+    Action playerAction = Action::STAY;
+    if (upPressed && !downPressed) {
+        playerAction = Action::UP;
+    } else if (downPressed && !upPressed) {
+        playerAction = Action::DOWN;
+    }
 
-    // --- Player Movement ---
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) {
-        playerPaddle->moveUp(seconds);
+    int steps = scheduler.advance(dt.asSeconds());
+    float stepSeconds = scheduler.step_seconds();
+    for (int i = 0; i < steps; ++i) {
+        if (!stepPlaying(stepSeconds, playerAction)) {
+            break; // Game over: the rest of the frame is not simulated
+        }
     }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) {
-        playerPaddle->moveDown(seconds);
+
+    // --- AI Planning ---
+    // Real transitions come one per decision; with planning on, the Q-table agent replays its
+    // recorded ones in whatever is left of the frame once it has been simulated and (judging by
+    // the previous frame) drawn, so planning soaks up slack without pushing the frame past vsync
+    if (aiPlanning && aiLearningEnabled && aiAgentKind == AgentKind::QTable) {
+        float slackSeconds = frameSeconds - frameClock.getElapsedTime().asSeconds() - lastDrawTime.asSeconds() -
+                             planningMarginSeconds;
+        if (slackSeconds > 0.0f) {
+            tableAgent().plan(0, slackSeconds * 1e6);
+        }
     }
+}
 
-    // --- AI Update ---
-    updateAI(dt); // Let the AI decide and move its paddle
+// One fixed physics step of the Playing state
+bool Game::stepPlaying(float stepSeconds, Action playerAction) {
+    // --- AI Decision ---
+    // aiView was computed when the previous decision ended, so the CPU's view of the field is
+    // discretized once per decision (plus once after a reset).
+    if (scheduler.decision_due()) {
+        if (!aiStateValid) {
+            aiView = getCurrentViewForAI();
+            aiStateValid = true;
+        }
+        aiAction = chooseAiAction(aiView);
+        aiDecisionEvents = StepEvents();
+        aiDecisionSeconds = 0.0f;
+        scheduler.start_decision();
+    }
 
-    // --- Ball Movement & Wall Collision ---
-    int scoreEvent = ball->update(seconds); // Ball updates its position and checks wall collisions
+    // --- Physics: paddles, ball, walls and paddle collisions ---
+    StepEvents events = world.step(stepSeconds, playerAction, aiAction);
+    scheduler.finish_step();
+    if (events.leftHit) {
+        std::cout << "Player hit ball." << std::endl;
+    }
+    if (events.rightHit) {
+        std::cout << "CPU hit ball." << std::endl;
+    }
+    aiDecisionEvents.leftHit = aiDecisionEvents.leftHit || events.leftHit;
+    aiDecisionEvents.rightHit = aiDecisionEvents.rightHit || events.rightHit;
+    aiDecisionEvents.scoreEvent = events.scoreEvent;
+    aiDecisionSeconds += stepSeconds;
+
+    // --- AI Learning ---
+    // A point ends the decision early. Everything that happened to the CPU during the decision
+    // (hit, concede, wasted move) goes into one transition.
+    if (events.scoreEvent != 0) {
+        scheduler.end_decision();
+    }
+    if (scheduler.decision_due()) {
+        AgentView nextAiView = getCurrentViewForAI();
+        if (aiLearningEnabled) {
+            learnAiTransition(aiView, aiAction, aiDecisionEvents, nextAiView, aiDecisionSeconds);
+        }
+        aiView = nextAiView; // The state the CPU decides from next
+    }
 
     // --- Scoring ---
+    // The ball has already been served again by the simulation.
     bool scored = false;
-    if (scoreEvent == 1) { // Player scored
+    if (events.scoreEvent == 1) { // Player scored
         cpuScore--;
         scored = true;
         std::cout << "Player scored! Score: P=" << playerScore << " C=" << cpuScore << std::endl;
-    } else if (scoreEvent == -1) { // CPU scored
+    } else if (events.scoreEvent == -1) { // CPU scored
         playerScore--;
         scored = true;
          std::cout << "CPU scored! Score: P=" << playerScore << " C=" << cpuScore << std::endl;
@@ -334,21 +476,11 @@ void Game::updatePlaying(sf::Time dt) {
 
     if (scored) {
         updateScoreDisplay();
-        ball->reset(); // Reset ball after score
-        // If AI was involved in the score, update its Q-value for the previous state
-        if (aiStateInitialized) {
-             double reward = calculateReward(scoreEvent, false, false); // Calculate reward for the score event
-             State nextState = getCurrentStateForAI(); // Get state after reset (might be less useful here)
-             // It might be better to update based on the state *before* the score/reset.
-             // Let's assume the reward applies to the action leading to the score.
-             aiAgent.update_q_value(previousAiState, lastAiAction, reward, nextState);
-             std::cout << "AI Q-update (Score): Reward=" << reward << std::endl;
-        }
-         aiStateInitialized = false; // Need a new 'previous' state after reset
 
         // --- Check Game Over ---
         if (playerScore <= scoreToWin || cpuScore <= scoreToWin) {
             currentState = GameState::GameOver;
+            printAiStats();
             // Set Game Over message
             messageText.setString(playerScore <= scoreToWin ? "CPU Wins!" : "Player Wins!");
             sf::FloatRect textRect = messageText.getLocalBounds();
@@ -359,189 +491,97 @@ void Game::updatePlaying(sf::Time dt) {
             gameOverMenu = std::make_unique<Menu>(windowSize.x, windowSize.y,
                                       std::vector<std::string>{"Play Again", "Main Menu", "Exit"},
                                       playerScore <= scoreToWin ? "CPU Wins!" : "Player Wins!");
-            return; // Exit updatePlaying early as game is over
+            return false;
         }
     }
+    return true;
+}
 
+// The Q-table agent (always present, whichever agent plays)
+QLearningAgent& Game::tableAgent() {
+    return concrete_agent<QLearningAgent>(*aiAgents[static_cast<int>(AgentKind::QTable)]);
+}
 
-    // --- Paddle Collision ---
-    bool cpuHitBall = false;
-    sf::FloatRect ballBounds = ball->getGlobalBounds();
-    sf::FloatRect playerBounds = playerPaddle->getGlobalBounds();
-    sf::FloatRect cpuBounds = cpuPaddle->getGlobalBounds();
-
-    // Collision with player paddle
-    if (ballBounds.intersects(playerBounds)) {
-        // Check if ball is moving towards player (left) to prevent multi-hits
-        if (ball->getVelocity().x < 0) {
-            ball->bounceX();
-            ball->increaseSpeed(); // Optional: Speed up ball on hit
-            // Correct ball position slightly to prevent sticking
-            ball->setPosition(playerBounds.left + playerBounds.width + ball->getRadius() + 1.0f, ball->getPosition().y);
-             std::cout << "Player hit ball." << std::endl;
-        }
+// How the Q-table agent's greedy-action cache did this game (it only answers the Q-table's
+// learning decisions; the frozen policy and the other agents don't use it)
+void Game::printAiStats() const {
+    const QLearningAgent& agent = concrete_agent<QLearningAgent>(*aiAgents[static_cast<int>(AgentKind::QTable)]);
+    long hits = agent.get_action_cache_hits();
+    long decisions = hits + agent.get_action_cache_misses();
+    if (decisions > 0) {
+        std::cout << "AI action cache: " << hits << " of " << decisions << " greedy decisions ("
+                  << static_cast<int>(100.0 * hits / decisions + 0.5) << "%) reused the cached action." << std::endl;
     }
+}
 
-    // Collision with CPU paddle
-    if (ballBounds.intersects(cpuBounds)) {
-         // Check if ball is moving towards CPU (right)
-         if (ball->getVelocity().x > 0) {
-            ball->bounceX();
-            ball->increaseSpeed();
-            cpuHitBall = true; // Flag that the CPU successfully hit the ball
-            // Correct ball position slightly
-             ball->setPosition(cpuBounds.left - ball->getRadius() - 1.0f, ball->getPosition().y);
-             std::cout << "CPU hit ball." << std::endl;
-         }
+// Updates on state change are a Q-table feature; the other agents learn once per decision
+void Game::warnIfSemiMdpIgnored() const {
+    if (aiSemiMdp && aiAgentKind != AgentKind::QTable) {
+        std::cout << "Note: \"Updates: On state change\" only applies to the Q-table agent; the "
+                  << agent_kind_name(aiAgentKind) << " agent updates once per decision." << std::endl;
     }
-
-     // --- AI Learning Update (if no score occurred this frame) ---
-     // We update the AI based on the consequences of its *last* action.
-     if (!scored && aiStateInitialized) {
-         State currentStateAI = getCurrentStateForAI();
-         bool cpuMovedUnnecessarily = false; // Determine if the last move was unnecessary
-
-         // Define "unnecessary": CPU moved when ball is moving away from its side
-         if (lastAiAction != Action::STAY && ball->getVelocity().x < 0) {
-              // Check if ball is sufficiently far away? Or just moving away is enough?
-              // Let's start simple: penalize if moving when ball moves away.
-              cpuMovedUnnecessarily = true;
-              // std::cout << "CPU moved unnecessarily (ball moving left)." << std::endl;
-         }
-
-         double reward = calculateReward(0, cpuHitBall, cpuMovedUnnecessarily); // Calculate reward for this step
-         aiAgent.update_q_value(previousAiState, lastAiAction, reward, currentStateAI);
-         // Only print significant rewards for less spam
-         if (reward != 0.0) {
-             std::cout << "AI Q-update: Reward=" << reward << " (Hit:" << cpuHitBall << ", UnnecMove:" << cpuMovedUnnecessarily << ")" << std::endl;
-         }
-     }
-     // Store current state and chosen action for the *next* frame's update
-     // This happens *after* the potential Q-update for the *previous* action.
-     // We get the state *before* the AI makes its next move decision.
-     // previousAiState = getCurrentStateForAI(); // State before AI action
-     // lastAiAction = aiAgent.choose_action(previousAiState); // AI chooses action for *next* frame
-     // aiStateInitialized = true;
-     // The AI update logic is moved to updateAI() for clarity.
-
-
-    // --- Update Paddle Positions (ensure shape matches internal state) ---
-    // This might be redundant if move/set functions always update the shape, but safe.
-    playerPaddle->update(seconds);
-    cpuPaddle->update(seconds);
 }
 
-// Update AI logic
-void Game::updateAI(sf::Time dt) {
-    float seconds = dt.asSeconds();
-
-    // 1. Get the current state for the AI
-    State currentStateAI = getCurrentStateForAI();
-
-    // 2. If we have a valid previous state, calculate reward and update Q-table
-    //    This update is for the action taken *last* frame, leading to the *current* state.
-    if (aiStateInitialized) {
-        // We need to know if the CPU hit the ball *as a result* of the last action.
-        // This is tricky because collision happens *after* the move.
-        // Let's simplify: Reward for hitting the ball is handled separately in updatePlaying.
-        // Here, we focus on the penalty for unnecessary movement.
-
-        bool cpuMovedUnnecessarily = false;
-         // Check if the ball is moving away from the CPU *in the current state*
-         // And if the *last action* was a move.
-         if (lastAiAction != Action::STAY && currentStateAI.ball_vx_category < 0) { // Assuming -1 means moving left (away from CPU)
-             cpuMovedUnnecessarily = true;
-         }
-
-        // Calculate reward (only penalty here, hit reward handled elsewhere)
-        double reward = calculateReward(0, false, cpuMovedUnnecessarily);
-        aiAgent.update_q_value(previousAiState, lastAiAction, reward, currentStateAI);
-
-        if (reward != 0.0) {
-             // std::cout << "AI Q-update (Movement Penalty): Reward=" << reward << std::endl;
-        }
+// Choose the AI's next action from its current state
+Action Game::chooseAiAction(const AgentView& view) {
+    // Frozen play mode: the Q-table plays its compiled greedy policy, the other agents their
+    // greedy action; nothing is learned
+    if (!aiLearningEnabled) {
+        if (aiAgentKind == AgentKind::QTable) return aiPolicy.choose_action(view.state);
+        return currentAiAgent().best_action(view);
     }
+    return currentAiAgent().choose_action(view);
+}
 
-    // 3. Choose the *next* action based on the *current* state
-    Action chosenAction = aiAgent.choose_action(currentStateAI);
-
-    // 4. Execute the chosen action
-    if (chosenAction == Action::UP) {
-        cpuPaddle->moveUp(seconds);
-        // std::cout << "AI Action: UP" << std::endl;
-    } else if (chosenAction == Action::DOWN) {
-        cpuPaddle->moveDown(seconds);
-        // std::cout << "AI Action: DOWN" << std::endl;
+// Learn from one completed decision: exactly one transition, however many physics steps it held
+void Game::learnAiTransition(const AgentView& view, Action action, const StepEvents& events,
+                             const AgentView& nextView, float seconds) {
+    double reward = calculateReward(events, action, nextView.state);
+    if (aiSemiMdp && aiAgentKind == AgentKind::QTable) {
+        // Accumulate; the Q-update happens when the discretized state changes or the point ends
+        aiTransition.observe(tableAgent(), view.state, action, reward, nextView.state, seconds);
+        if (events.scoreEvent != 0) {
+            aiTransition.flush(tableAgent());
+        }
     } else {
-        // Action::STAY - do nothing
-        // std::cout << "AI Action: STAY" << std::endl;
+        // Queue it for the next learning pass. Gamma is the discount per DISCOUNT_TIME_STEP,
+        // so a decision's value is discounted by the time it actually spanned.
+        AiExperience experience;
+        experience.view = view;
+        experience.action = action;
+        experience.reward = reward;
+        experience.nextView = nextView;
+        experience.discount = std::pow(currentAiAgent().get_gamma(), seconds / DISCOUNT_TIME_STEP);
+        aiPendingExperience.push_back(experience);
+        if (aiPendingExperience.size() >= static_cast<size_t>(scheduler.get_rates().learning_batch)) {
+            applyAiExperience();
+        }
     }
-
-    // 5. Store the current state and chosen action for the *next* frame's update
-    previousAiState = currentStateAI;
-    lastAiAction = chosenAction;
-    aiStateInitialized = true;
-}
-
-
-// Convert game state to discrete AI state representation
-State Game::getCurrentStateForAI() const {
-    State current;
-    sf::Vector2f ballPos = ball->getPosition();
-    sf::Vector2f ballVel = ball->getVelocity();
-    sf::Vector2f cpuPos = cpuPaddle->getPosition();
-    sf::Vector2f playerPos = playerPaddle->getPosition();
-
-    // Discretize ball position
-    current.ball_x_grid = static_cast<int>(std::floor(ballPos.x / (windowSize.x / static_cast<float>(GRID_X_DIVISIONS))));
-    current.ball_y_grid = static_cast<int>(std::floor(ballPos.y / (windowSize.y / static_cast<float>(GRID_Y_DIVISIONS))));
-    // Clamp grid indices to valid range
-    current.ball_x_grid = std::max(0, std::min(GRID_X_DIVISIONS - 1, current.ball_x_grid));
-    current.ball_y_grid = std::max(0, std::min(GRID_Y_DIVISIONS - 1, current.ball_y_grid));
-
-
-    // Discretize ball velocity
-    current.ball_vx_category = (ballVel.x > 0) ? 1 : ((ballVel.x < 0) ? -1 : 0);
-    current.ball_vy_category = (ballVel.y > 0) ? 1 : ((ballVel.y < 0) ? -1 : 0); // 1 for down, -1 for up
-
-    // Discretize paddle positions (using center of paddle for simplicity)
-    float cpuCenterY = cpuPos.y + PADDLE_HEIGHT / 2.0f;
-    float playerCenterY = playerPos.y + PADDLE_HEIGHT / 2.0f;
-
-    current.cpu_paddle_y_grid = static_cast<int>(std::floor(cpuCenterY / (windowSize.y / static_cast<float>(PADDLE_Y_DIVISIONS))));
-    current.player_paddle_y_grid = static_cast<int>(std::floor(playerCenterY / (windowSize.y / static_cast<float>(PADDLE_Y_DIVISIONS))));
-     // Clamp grid indices
-    current.cpu_paddle_y_grid = std::max(0, std::min(PADDLE_Y_DIVISIONS - 1, current.cpu_paddle_y_grid));
-    current.player_paddle_y_grid = std::max(0, std::min(PADDLE_Y_DIVISIONS - 1, current.player_paddle_y_grid));
-
-    return current;
-}
-
-// Calculate reward for the AI based on events
-double Game::calculateReward(int scoreEvent, bool cpuHitBall, bool cpuMovedUnnecessarily) const {
-    double reward = 0.0;
-
-    // Reward for hitting the ball (positive reinforcement)
-    if (cpuHitBall) {
-        reward += 10.0;
+    // Only print significant rewards for less spam
+    if (events.scoreEvent != 0 || events.rightHit) {
+        std::cout << "AI Q-update: Reward=" << reward << std::endl;
     }
+}
 
-    // Penalty for conceding a goal (negative reinforcement)
-    if (scoreEvent == -1) { // CPU conceded (player scored)
-        reward -= 20.0; // Significant penalty
+// Apply the queued decisions, oldest first, to the agent that is playing
+void Game::applyAiExperience() {
+    Agent& agent = currentAiAgent();
+    for (const AiExperience& experience : aiPendingExperience) {
+        agent.observe(experience.view, experience.action, experience.reward, experience.nextView,
+                      experience.discount);
     }
-    // Note: No direct reward for scoring, as hitting the ball leads to that.
-    // Could add a small reward for player conceding (scoreEvent == 1), but might be redundant.
+    aiPendingExperience.clear();
+}
 
-    // Penalty for unnecessary movement
-    if (cpuMovedUnnecessarily) {
-        reward -= 5.0; // Penalty specified
-    }
 
-    // Small penalty for existing? Encourages faster wins? (Optional, can be risky)
-    // reward -= 0.1;
+// Convert game state to the AI's representations (discrete and continuous)
+AgentView Game::getCurrentViewForAI() const {
+    return world.getRightView(); // The CPU plays the right paddle
+}
 
-    return reward;
+// Calculate reward for the AI based on the events of one step (the CPU plays the right paddle)
+double Game::calculateReward(const StepEvents& events, Action cpuAction, const State& nextState) const {
+    return compute_step_reward(events, true, cpuAction, nextState);
 }
 
 
@@ -562,6 +602,7 @@ void Game::drawCenterLine() {
 
 // Render the game screen
 void Game::render() {
+    sf::Clock drawClock;
     window.clear(sf::Color::Black); // Clear screen with black background
 
     // Draw elements based on game state
@@ -570,9 +611,9 @@ void Game::render() {
         case GameState::Paused: // Draw game elements even when paused
         case GameState::GameOver: // Draw final game state behind game over menu
             drawCenterLine();
-            window.draw(playerPaddle->getShape());
-            window.draw(cpuPaddle->getShape());
-            window.draw(ball->getShape());
+            window.draw(world.getLeftPaddle().getShape());
+            window.draw(world.getRightPaddle().getShape());
+            window.draw(world.getBall().getShape());
             window.draw(scoreTextPlayer);
             window.draw(scoreTextCPU);
 
@@ -595,6 +636,7 @@ void Game::render() {
             break;
     }
 
+    lastDrawTime = drawClock.getElapsedTime(); // What the frame deadline must leave room for
 
     window.display(); // Update the window with the drawn elements
 }
@@ -2,12 +2,15 @@
 #define PONG_GAME_H
 
 #include <SFML/Graphics.hpp>
-#include "Paddle.h"
-#include "Ball.h"
-#include "QLearningAgent.h"
+#include "Simulation.h"
+#include "Agent.h"
+#include "GreedyPolicy.h"
+#include "SemiMdp.h"
+#include "Scheduler.h"
 #include "Menu.h"
 #include "State.h"
 #include <memory> // For std::unique_ptr
+#include <vector>
 
 // Define the different states the game can be in
 enum class GameState {
@@ -30,16 +33,39 @@ private:
     sf::RectangleShape centerLine; // Dashed line effect will be drawn manually
 
     // --- Game Objects ---
-    std::unique_ptr<Paddle> playerPaddle;
-    std::unique_ptr<Paddle> cpuPaddle;
-    std::unique_ptr<Ball> ball;
+    Simulation world; // Paddles and ball (player on the left, CPU on the right)
 
     // --- AI ---
-    QLearningAgent aiAgent;
-    State previousAiState; // Store the state before the AI's last action
-    Action lastAiAction;   // Store the last action the AI took
-    bool aiStateInitialized; // Flag to check if previousAiState is valid
+    std::vector<std::unique_ptr<Agent>> aiAgents; // One of each AgentKind, indexed by it
+    AgentKind aiAgentKind; // Which of the agents plays (and learns)
+    AgentView aiView;  // The CPU's view of the field at the start of its current decision
+    bool aiStateValid; // False after a reset: aiView must be recomputed before the next decision
+    Action aiAction;   // Action held until the next decision
+    StepEvents aiDecisionEvents; // What happened to the CPU since the current decision started
+    float aiDecisionSeconds;     // Simulated time since the current decision started
     DifficultyLevel currentDifficulty; // Store the selected difficulty
+    bool aiLearningEnabled; // When false the AI plays the frozen aiPolicy and does not learn
+    GreedyPolicy aiPolicy;  // Greedy actions compiled from the Q-table when learning is turned off
+    bool aiSemiMdp;         // Learn once per change of discretized state instead of every decision (Q-table only)
+    SemiMdpAccumulator aiTransition; // Reward accumulated in the current state (semi-MDP mode)
+    bool aiPlanning;        // Dyna-Q: the Q-table agent replays its recorded transitions in each frame's spare time
+
+    // One completed decision waiting for the next learning pass (per-decision mode).
+    struct AiExperience {
+        AgentView view;
+        Action action;
+        double reward;
+        AgentView nextView;
+        double discount; // gamma^(decision time / DISCOUNT_TIME_STEP)
+    };
+    std::vector<AiExperience> aiPendingExperience;
+
+    // --- Timing ---
+    FixedStepScheduler scheduler; // Physics steps, AI decision and learning rates (per difficulty)
+    sf::Clock frameClock;  // Time since the current frame started
+    sf::Time lastDrawTime; // Time the previous frame took to draw (up to display, which waits for vsync)
+    float frameSeconds;    // Frame deadline: the display's refresh period, measured (see measureFramePeriod)
+    const float planningMarginSeconds = 0.002f; // Left free before the deadline, for timing jitter
 
     // --- Game State & Logic ---
     GameState currentState;
@@ -59,24 +85,34 @@ private:
     void processEvents();       // Handle window events and user input
     void update(sf::Time dt);   // Update game logic (movement, AI, collisions)
     void render();              // Draw everything to the window
+    void measureFramePeriod(sf::Time dt); // Update frameSeconds from the last frame's length
 
     void handlePlayerInput(sf::Keyboard::Key key, bool isPressed); // Handle key presses/releases
     void handleMenuInput(sf::Keyboard::Key key); // Handle input specific to menus
 
     void updatePlaying(sf::Time dt); // Update logic specific to the Playing state
-    void updateAI(sf::Time dt);      // Update the AI's decision and paddle movement
+    bool stepPlaying(float stepSeconds, Action playerAction); // One physics step; false once the game is over
+    Agent& currentAiAgent() { return *aiAgents[static_cast<int>(aiAgentKind)]; } // The agent that plays
+    QLearningAgent& tableAgent(); // The Q-table agent (frozen policy, semi-MDP mode, baked policy)
+    Action chooseAiAction(const AgentView& view); // The AI's next action
+    void learnAiTransition(const AgentView& view, Action action, const StepEvents& events,
+                           const AgentView& nextView, float seconds); // One completed decision
+    void applyAiExperience(); // Learn from the pending decisions
+    void warnIfSemiMdpIgnored() const; // Say so when the update mode is set but the agent can't use it
+    void printAiStats() const; // Action cache hit rate of the game just played
 
     void resetGame();           // Reset scores, paddles, ball
     void setupText();           // Initialize score and message text objects
     void setupMenus();          // Initialize menu objects
+    void updateOptionsMenuText(); // Show the current difficulty and learning modes in the options menu
     void updateScoreDisplay();  // Update the score text strings
     void drawCenterLine();      // Draw the dashed center line
 
     // AI State Conversion
-    State getCurrentStateForAI() const; // Convert current game situation to a discrete AI State
+    AgentView getCurrentViewForAI() const; // Current game situation as the AI sees it (discrete and continuous)
 
-    // AI Reward Calculation
-    double calculateReward(int scoreEvent, bool cpuHitBall, bool cpuMovedUnnecessarily) const;
+    // AI Reward Calculation: everything that happened to the CPU in one step, as one reward
+    double calculateReward(const StepEvents& events, Action cpuAction, const State& nextState) const;
 
 
 public:
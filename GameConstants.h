@@ -0,0 +1,15 @@
+#ifndef PONG_GAMECONSTANTS_H
+#define PONG_GAMECONSTANTS_H
+
+// --- Constants ---
+// Field and object dimensions shared by the game and the headless simulation.
+const unsigned int WINDOW_WIDTH = 800;
+const unsigned int WINDOW_HEIGHT = 600;
+const float PADDLE_WIDTH = 15.0f;
+const float PADDLE_HEIGHT = 80.0f;
+const float BALL_RADIUS = 8.0f;
+const float PADDLE_SPEED = 400.0f; // Pixels per second
+const float BALL_INITIAL_SPEED = 300.0f; // Pixels per second
+const float PADDLE_MARGIN = 20.0f; // Distance from edge
+
+#endif // PONG_GAMECONSTANTS_H
@@ -0,0 +1,43 @@
+#include "GreedyPolicy.h"
+#include <algorithm> // For std::max_element
+
+// Constructor: every state plays the default action
+GreedyPolicy::GreedyPolicy(Action default_action)
+    : actions(STATE_SPACE_SIZE, static_cast<std::uint8_t>(default_action))
+{
+}
+
+// Compile a Q-table into its greedy actions
+GreedyPolicy GreedyPolicy::compile(const QLearningAgent& agent, Action default_action) {
+    GreedyPolicy policy(default_action);
+    if (agent.get_coarse_levels() > 0 || agent.get_mirror_symmetry()) {
+        // States without a row of their own play what the agent would: their nearest learned
+        // coarse cell's best action, or their mirror image's with UP and DOWN swapped. So every
+        // state of the grid is asked.
+        State s;
+        for (s.ball_x_grid = 0; s.ball_x_grid < GRID_X_DIVISIONS; ++s.ball_x_grid)
+        for (s.ball_y_grid = 0; s.ball_y_grid < GRID_Y_DIVISIONS; ++s.ball_y_grid)
+        for (s.ball_vx_category = -1; s.ball_vx_category <= 1; ++s.ball_vx_category)
+        for (s.ball_vy_category = -1; s.ball_vy_category <= 1; ++s.ball_vy_category)
+        for (s.cpu_paddle_y_grid = 0; s.cpu_paddle_y_grid < PADDLE_Y_DIVISIONS; ++s.cpu_paddle_y_grid)
+        for (s.player_paddle_y_grid = 0; s.player_paddle_y_grid < PADDLE_Y_DIVISIONS; ++s.player_paddle_y_grid) {
+            QValues q_values;
+            if (agent.estimate_q_values(encode_state(s), q_values)) {
+                auto best = std::max_element(q_values.begin(), q_values.end());
+                policy.set_action(state_index(s), static_cast<Action>(best - q_values.begin()));
+            }
+        }
+        return policy;
+    }
+    agent.get_q_table().for_each([&policy, &agent](StateKey key, const QRow&) {
+        State s = decode_state(key);
+        if (!state_in_default_grid(s)) {
+            return; // Loaded from a table with a different discretization
+        }
+        // Same tie-breaking as the agent: the first action with the maximum Q-value
+        QValues q_values = agent.get_q_values(key);
+        auto best = std::max_element(q_values.begin(), q_values.end());
+        policy.set_action(state_index(s), static_cast<Action>(best - q_values.begin()));
+    });
+    return policy;
+}
@@ -0,0 +1,37 @@
+#ifndef PONG_GREEDYPOLICY_H
+#define PONG_GREEDYPOLICY_H
+
+#include "State.h"
+#include "QLearningAgent.h"
+#include <cstdint> // For uint8_t
+#include <vector>
+
+// A Q-table compiled down to its greedy decisions: one byte (the best Action) per state of
+// the default discretization, indexed by state_index. Used when the AI plays without learning,
+// where choosing an action is then a single indexed load with no hashing and no Q-values.
+class GreedyPolicy {
+private:
+    std::vector<std::uint8_t> actions; // Best action per dense state index
+
+public:
+    // Creates a policy that plays `default_action` everywhere.
+    explicit GreedyPolicy(Action default_action = Action::STAY);
+
+    // Compiles the agent's current Q-table. States the agent has never seen get `default_action`
+    // (with coarse levels, only states whose coarse cells have learned nothing either).
+    static GreedyPolicy compile(const QLearningAgent& agent, Action default_action = Action::STAY);
+
+    // The greedy action for a state.
+    Action choose_action(const State& state) const {
+        return static_cast<Action>(actions[state_index(state)]);
+    }
+
+    // The greedy action for a dense state index.
+    Action action_at(size_t index) const { return static_cast<Action>(actions[index]); }
+    void set_action(size_t index, Action action) { actions[index] = static_cast<std::uint8_t>(action); }
+
+    // Number of states covered (STATE_SPACE_SIZE).
+    size_t size() const { return actions.size(); }
+};
+
+#endif // PONG_GREEDYPOLICY_H
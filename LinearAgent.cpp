@@ -0,0 +1,183 @@
+#include "LinearAgent.h"
+#include <algorithm> // For std::max_element, std::min, std::max
+#include <cmath>     // For std::fabs
+#include <fstream>   // For file I/O
+#include <iostream>  // For error messages
+#include <iomanip>   // For std::setprecision
+
+// Offset scaled so that +/-1 is reached `gain` times closer than the field height
+static float clamped_offset(float offset, float gain) {
+    return std::max(-1.0f, std::min(1.0f, offset * gain));
+}
+
+// Constructor
+LinearAgent::LinearAgent(unsigned int seed)
+    : alpha(0.1), gamma(0.9), epsilon(0.1), // Easy parameters
+      update_count(0),
+      rng(seed),
+      exploration_distribution(0.0, 1.0),
+      action_distribution(0, NUM_ACTIONS - 1)
+{
+    for (int a = 0; a < NUM_ACTIONS; ++a) {
+        for (int i = 0; i < LINEAR_FEATURES; ++i) {
+            weights[a][i] = 0.0f;
+        }
+    }
+}
+
+// Set difficulty parameters (the same levels as the tabular agent)
+void LinearAgent::set_difficulty(DifficultyLevel level) {
+    switch (level) {
+        case DifficultyLevel::EASY:   set_parameters(0.1, 0.9, 0.1); break;
+        case DifficultyLevel::MEDIUM: set_parameters(0.2, 0.9, 0.2); break;
+        case DifficultyLevel::HARD:   set_parameters(0.2, 0.95, 0.4); break;
+    }
+}
+
+// Set learning parameters directly
+void LinearAgent::set_parameters(double new_alpha, double new_gamma, double new_epsilon) {
+    alpha = new_alpha;
+    gamma = new_gamma;
+    epsilon = new_epsilon;
+}
+
+// Build the feature vector
+LinearFeatures LinearAgent::features(const Observation& o) {
+    float offset = o.ball_y - o.cpu_paddle_y;               // Where the ball is, relative to the paddle
+    float intercept_offset = o.ball_intercept_y - o.cpu_paddle_y; // Where it will arrive
+    float approaching = (o.ball_vx > 0.0f) ? 1.0f : 0.0f;
+
+    LinearFeatures phi;
+    phi.f[0] = 1.0f; // Bias
+    phi.f[1] = o.ball_x;
+    phi.f[2] = o.ball_y - 0.5f;
+    phi.f[3] = o.ball_vx;
+    phi.f[4] = o.ball_vy;
+    phi.f[5] = o.cpu_paddle_y - 0.5f;
+    phi.f[6] = o.player_paddle_y - 0.5f;
+    phi.f[7] = clamped_offset(offset, 4.0f);
+    phi.f[8] = std::fabs(phi.f[7]);
+    phi.f[9] = clamped_offset(intercept_offset, 4.0f);
+    phi.f[10] = std::fabs(phi.f[9]);
+    phi.f[11] = approaching;
+    phi.f[12] = approaching * phi.f[9];
+    phi.f[13] = approaching * phi.f[10];
+    phi.f[14] = clamped_offset(intercept_offset, 16.0f); // Saturates about one paddle height away
+    phi.f[15] = 0.0f; // Padding
+    return phi;
+}
+
+// Dot products of every action's weights with the features. Products are accumulated lane by
+// lane in an 8-wide array and reduced at the end, so the compiler can keep the whole loop in
+// vector registers without reordering a floating-point sum.
+QValues LinearAgent::q_values(const LinearFeatures& phi) const {
+    QValues q;
+    for (int a = 0; a < NUM_ACTIONS; ++a) {
+        alignas(32) float lanes[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < LINEAR_FEATURES; i += 8) {
+            for (int j = 0; j < 8; ++j) {
+                lanes[j] += weights[a][i + j] * phi.f[i + j];
+            }
+        }
+        q[a] = ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) + ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+    }
+    return q;
+}
+
+// Greedy action (first maximum)
+Action LinearAgent::best_action(const Observation& observation) const {
+    QValues q = get_q_values(observation);
+    return static_cast<Action>(std::max_element(q.begin(), q.end()) - q.begin());
+}
+
+// Choose an action using epsilon-greedy
+Action LinearAgent::choose_action(const Observation& observation) {
+    if (exploration_distribution(rng) < epsilon) {
+        return static_cast<Action>(action_distribution(rng)); // Explore
+    }
+    QValues q = get_q_values(observation);
+    if (q[0] == q[1] && q[1] == q[2]) {
+        return static_cast<Action>(action_distribution(rng)); // Nothing learned yet
+    }
+    return static_cast<Action>(std::max_element(q.begin(), q.end()) - q.begin());
+}
+
+// Update the weights using the Q-learning formula
+void LinearAgent::update_q_value(const Observation& old_observation, Action action, double reward,
+                                 const Observation& new_observation) {
+    update_q_value(old_observation, action, reward, new_observation, gamma);
+}
+
+// Update the weights with an explicit discount on the future value
+void LinearAgent::update_q_value(const Observation& old_observation, Action action, double reward,
+                                 const Observation& new_observation, double discount) {
+    int action_index = static_cast<int>(action);
+
+    QValues next_q_values = get_q_values(new_observation);
+    double max_future_q = *std::max_element(next_q_values.begin(), next_q_values.end());
+
+    LinearFeatures phi = features(old_observation);
+    double old_q_value = q_values(phi)[action_index];
+
+    float norm = 0.0f;
+    for (int i = 0; i < LINEAR_FEATURES; ++i) {
+        norm += phi.f[i] * phi.f[i];
+    }
+    double error = reward + discount * max_future_q - old_q_value;
+    float step = static_cast<float>(alpha * error / norm); // norm >= 1 (the bias feature)
+
+    // Gradient step on the chosen action's weights (one fused multiply-add per lane)
+    float* w = weights[action_index];
+    for (int i = 0; i < LINEAR_FEATURES; ++i) {
+        w[i] += step * phi.f[i];
+    }
+    update_count++;
+}
+
+// Save the weights: a header line, then one line of weights per action
+bool LinearAgent::save_weights(const std::string& filename) const {
+    std::ofstream outfile(filename);
+    if (!outfile.is_open()) {
+        std::cerr << "Error: Could not open file for saving linear weights: " << filename << std::endl;
+        return false;
+    }
+    outfile << "linear " << NUM_ACTIONS << " " << LINEAR_FEATURES << "\n";
+    outfile << std::setprecision(9); // Round-trips a float
+    for (int a = 0; a < NUM_ACTIONS; ++a) {
+        for (int i = 0; i < LINEAR_FEATURES; ++i) {
+            outfile << (i ? " " : "") << weights[a][i];
+        }
+        outfile << "\n";
+    }
+    outfile.close();
+    std::cout << "Linear weights saved to " << filename << std::endl;
+    return true;
+}
+
+// Load weights saved by save_weights
+bool LinearAgent::load_weights(const std::string& filename) {
+    std::ifstream infile(filename);
+    if (!infile.is_open()) {
+        std::cerr << "Error: Could not open file for loading linear weights: " << filename << std::endl;
+        return false;
+    }
+    std::string magic;
+    int actions = 0;
+    int feature_count = 0;
+    if (!(infile >> magic >> actions >> feature_count) || magic != "linear" ||
+        actions != NUM_ACTIONS || feature_count != LINEAR_FEATURES) {
+        std::cerr << "Error: " << filename << " was saved with a different feature layout." << std::endl;
+        return false;
+    }
+    float loaded[NUM_ACTIONS][LINEAR_FEATURES];
+    for (int a = 0; a < NUM_ACTIONS; ++a) {
+        for (int i = 0; i < LINEAR_FEATURES; ++i) {
+            if (!(infile >> loaded[a][i])) {
+                std::cerr << "Error: " << filename << " is truncated." << std::endl;
+                return false;
+            }
+        }
+    }
+    std::copy(&loaded[0][0], &loaded[0][0] + NUM_ACTIONS * LINEAR_FEATURES, &weights[0][0]);
+    return true;
+}
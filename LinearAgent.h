@@ -0,0 +1,94 @@
+#ifndef PONG_LINEARAGENT_H
+#define PONG_LINEARAGENT_H
+
+#include "State.h"
+#include "QLearningAgent.h" // For Action, QValues, DifficultyLevel
+#include <random>
+#include <string>
+
+// Number of features per observation, padded to a multiple of 8 floats so every weight row and
+// the feature vector are whole 32-byte vectors (see LinearAgent::features for the list).
+const int LINEAR_FEATURES = 16;
+
+// Feature vector of one observation.
+struct alignas(32) LinearFeatures {
+    float f[LINEAR_FEATURES];
+};
+
+// Q-learning with a linear Q-function over continuous features of the Observation:
+//   Q(s, a) = w_a . phi(s)
+// phi holds the normalized positions and ball direction, the ball's offset from the CPU paddle
+// (now and at its predicted intercept) and a few products of those, so the agent can react to
+// situations it has never seen exactly. The whole model is NUM_ACTIONS * LINEAR_FEATURES floats
+// (192 bytes), against megabytes for a Q-table.
+//
+// Updates use the normalized step alpha / |phi|^2 (NLMS), which keeps the weights stable
+// whatever the scale of the features. Same choose/update interface as TileCodingAgent.
+class LinearAgent {
+private:
+    alignas(32) float weights[NUM_ACTIONS][LINEAR_FEATURES];
+
+    double alpha;
+    double gamma;
+    double epsilon;
+
+    long update_count; // Updates applied so far
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> exploration_distribution;
+    std::uniform_int_distribution<int> action_distribution;
+
+    // Q-values of all actions for a feature vector.
+    QValues q_values(const LinearFeatures& phi) const;
+
+public:
+    // Constructor with a fixed random seed. Starts with the EASY parameters and all weights zero.
+    explicit LinearAgent(unsigned int seed = std::random_device{}());
+
+    // Feature vector of an observation.
+    static LinearFeatures features(const Observation& observation);
+
+    // Same levels as QLearningAgent::set_difficulty (silently).
+    void set_difficulty(DifficultyLevel level);
+
+    // Sets alpha, gamma and epsilon directly.
+    void set_parameters(double new_alpha, double new_gamma, double new_epsilon);
+
+    // Re-seeds the exploration random number generator.
+    void seed(unsigned int seed) { rng.seed(seed); }
+
+    // Epsilon-greedy action. While all Q-values are equal (nothing learned yet) the action is random.
+    Action choose_action(const Observation& observation);
+
+    // Greedy action (no exploration, first maximum on ties).
+    Action best_action(const Observation& observation) const;
+
+    // Q-values of all actions for an observation.
+    QValues get_q_values(const Observation& observation) const { return q_values(features(observation)); }
+
+    // Q-learning update (semi-gradient):
+    //   w_a += alpha / |phi(s)|^2 * [reward + gamma * max Q(s', .) - Q(s, a)] * phi(s)
+    void update_q_value(const Observation& old_observation, Action action, double reward,
+                        const Observation& new_observation);
+
+    // Same update with an explicit discount instead of gamma (see SemiMdp.h).
+    void update_q_value(const Observation& old_observation, Action action, double reward,
+                        const Observation& new_observation, double discount);
+
+    // Saves the weights to a text file / loads them back.
+    bool save_weights(const std::string& filename) const;
+    bool load_weights(const std::string& filename);
+
+    double get_alpha() const { return alpha; }
+    double get_gamma() const { return gamma; }
+    double get_epsilon() const { return epsilon; }
+
+    // Number of updates applied since construction.
+    long get_update_count() const { return update_count; }
+
+    // Number of weights and the bytes they use.
+    size_t get_weight_count() const { return static_cast<size_t>(NUM_ACTIONS) * LINEAR_FEATURES; }
+    size_t memory_bytes() const { return sizeof(weights); }
+};
+
+#endif // PONG_LINEARAGENT_H
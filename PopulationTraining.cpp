@@ -0,0 +1,117 @@
+#include "PopulationTraining.h"
+#include <algorithm> // For std::sort, std::min, std::max
+#include <iostream>
+
+// Constructor
+PopulationTrainer::PopulationTrainer(const PopulationConfig& config, const QLearningAgent& initial)
+    : config(config), working(config.population), published(config.population),
+      members_running(0), rng(config.seed)
+{
+    for (size_t i = 0; i < config.population; ++i) {
+        PopulationMember& member = working[i];
+        member.agent = initial;
+        member.agent.seed(config.seed + 1000u * static_cast<unsigned int>(i + 1));
+        member.config = config.base;
+        if (i > 0) { // Keep the base hyperparameters in the population once
+            member.config.alpha = perturb(config.base.alpha);
+            member.config.gamma = std::min(0.999, 1.0 - perturb(1.0 - config.base.gamma));
+            member.config.epsilon = perturb(config.base.epsilon);
+        }
+        published[i] = member;
+    }
+}
+
+// Scale by 1 +/- perturb_factor
+double PopulationTrainer::perturb(double value) {
+    std::bernoulli_distribution coin(0.5);
+    double scaled = value * (coin(rng) ? 1.0 + config.perturb_factor : 1.0 - config.perturb_factor);
+    return std::max(1e-4, std::min(1.0, scaled));
+}
+
+// Copy a strong member into a weak one and perturb its hyperparameters
+void PopulationTrainer::exploit_and_explore(size_t index) {
+    // Rank the members that have been scored at least once
+    std::vector<size_t> ranked;
+    for (size_t i = 0; i < published.size(); ++i) {
+        if (published[i].score >= 0.0) ranked.push_back(i);
+    }
+    if (ranked.size() < 2) return;
+    std::sort(ranked.begin(), ranked.end(), [this](size_t a, size_t b) {
+        return published[a].score > published[b].score;
+    });
+    size_t cutoff = std::max<size_t>(1, static_cast<size_t>(ranked.size() * config.exploit_fraction));
+    size_t rank = std::find(ranked.begin(), ranked.end(), index) - ranked.begin();
+    if (rank < ranked.size() - cutoff) return; // Not in the bottom fraction
+
+    std::uniform_int_distribution<size_t> pick(0, cutoff - 1);
+    size_t source = ranked[pick(rng)];
+    if (published[source].score <= published[index].score) return; // Nothing better to copy
+
+    // Exploit: take over the stronger member's table (a flat copy) and hyperparameters
+    PopulationMember& member = working[index];
+    int interval = member.interval;
+    member.agent = published[source].agent;
+    member.agent.seed(config.seed + 1000u * static_cast<unsigned int>(index + 1) + static_cast<unsigned int>(interval));
+    member.config = published[source].config;
+    member.steps = published[source].steps;
+    member.exploits++;
+
+    // Explore: perturb the copied hyperparameters
+    member.config.alpha = perturb(member.config.alpha);
+    member.config.gamma = std::min(0.999, 1.0 - perturb(1.0 - member.config.gamma));
+    member.config.epsilon = perturb(member.config.epsilon);
+
+    std::cout << "  member " << index << " (win rate " << published[index].score << ") <- member " << source
+              << " (win rate " << published[source].score << "), alpha=" << member.config.alpha
+              << " gamma=" << member.config.gamma << " epsilon=" << member.config.epsilon << std::endl;
+}
+
+// One interval of one member
+void PopulationTrainer::run_interval(size_t index, ThreadPool& pool) {
+    PopulationMember& member = working[index];
+    TrainingConfig job = member.config;
+    job.steps = config.interval_steps;
+    job.window_steps = config.interval_steps;
+    job.seed = config.seed + 7919u * static_cast<unsigned int>(index) + 104729u * static_cast<unsigned int>(member.interval);
+    TrainingResult result = run_training_job(job, member.agent);
+    member.score = result.final_win_rate;
+    member.steps += config.interval_steps;
+    member.interval++;
+
+    bool finished = (member.interval >= config.intervals);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        published[index] = member; // Publish before deciding, so others can copy from it
+        if (!finished) {
+            exploit_and_explore(index);
+        } else if (--members_running == 0) {
+            all_done.notify_all();
+        }
+    }
+    if (!finished) {
+        pool.submit([this, index, &pool] { run_interval(index, pool); });
+    }
+}
+
+// Train the whole population
+void PopulationTrainer::run() {
+    ThreadPool pool(config.threads);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        members_running = working.size();
+    }
+    for (size_t i = 0; i < working.size(); ++i) {
+        pool.submit([this, i, &pool] { run_interval(i, pool); });
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    all_done.wait(lock, [this] { return members_running == 0; });
+}
+
+// Highest final score
+const PopulationMember& PopulationTrainer::best() const {
+    size_t best_index = 0;
+    for (size_t i = 1; i < published.size(); ++i) {
+        if (published[i].score > published[best_index].score) best_index = i;
+    }
+    return published[best_index];
+}
@@ -0,0 +1,76 @@
+#ifndef PONG_POPULATIONTRAINING_H
+#define PONG_POPULATIONTRAINING_H
+
+#include "TrainingJob.h"
+#include "QLearningAgent.h"
+#include "ThreadPool.h"
+#include <condition_variable>
+#include <cstddef> // For size_t
+#include <mutex>
+#include <random>
+#include <vector>
+
+// Settings for population-based training.
+struct PopulationConfig {
+    size_t population = 8;          // Number of agents trained side by side
+    long interval_steps = 200000;   // Training steps between exploit/explore decisions
+    int intervals = 20;             // Intervals per member
+    double exploit_fraction = 0.25; // Bottom fraction copies from the top fraction
+    double perturb_factor = 0.2;    // Explore: scale hyperparameters by 1 +/- this
+    size_t threads = 0;             // Worker threads (0 = one per hardware thread)
+    unsigned int seed = 1;
+    TrainingConfig base;            // Opponent, grid, evaluation and the starting hyperparameters
+};
+
+// One member of the population as last published: its agent, its hyperparameters and the win
+// rate it scored at the end of its latest interval.
+struct PopulationMember {
+    QLearningAgent agent;
+    TrainingConfig config;
+    double score = -1.0;   // Greedy win rate after the latest interval (-1 before the first)
+    int interval = 0;      // Intervals completed
+    int exploits = 0;      // Times this member was replaced by a copy of a stronger one
+    long steps = 0;        // Training steps behind its current table (including inherited ones)
+
+    PopulationMember() : agent(0u) {}
+};
+
+// Population-based training (exploit/explore). Every member trains against the scripted
+// opponent for `interval_steps` and is then scored by greedy play. A member in the bottom
+// `exploit_fraction` of the latest scores copies the Q-table and hyperparameters of a random
+// member from the top fraction (a flat memcpy of the table), then perturbs alpha, gamma and
+// epsilon. Scheduling is asynchronous: each finished interval immediately queues that member's
+// next one on the thread pool, and decisions use whatever scores are published at that moment,
+// so no worker waits for a whole generation to finish.
+class PopulationTrainer {
+private:
+    PopulationConfig config;
+    std::vector<PopulationMember> working;   // Trained by that member's current job only
+    std::vector<PopulationMember> published; // Latest finished state of each member (guarded by mutex)
+    std::mutex mutex;
+    std::condition_variable all_done;
+    size_t members_running;
+    std::mt19937 rng; // Exploit/explore choices (guarded by mutex)
+
+    // Trains one interval of member `index`, publishes it, exploits/explores, then queues the next interval.
+    void run_interval(size_t index, ThreadPool& pool);
+
+    // Replaces a weak member with a perturbed copy of a strong one. Called with the mutex held.
+    void exploit_and_explore(size_t index);
+
+    // Multiplies a parameter by 1 - perturb_factor or 1 + perturb_factor at random.
+    double perturb(double value);
+
+public:
+    // Every member starts as a copy of `initial` with the base hyperparameters perturbed.
+    PopulationTrainer(const PopulationConfig& config, const QLearningAgent& initial);
+
+    // Trains the whole population to completion.
+    void run();
+
+    // Members after training; best() is the one with the highest final score.
+    const std::vector<PopulationMember>& get_members() const { return published; }
+    const PopulationMember& best() const;
+};
+
+#endif // PONG_POPULATIONTRAINING_H
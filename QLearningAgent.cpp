@@ -4,19 +4,46 @@
 #include <algorithm> // For std::max_element
 #include <fstream>   // For file I/O
 #include <iostream>  // For error messages
-#include <sstream>   // For string stream parsing
+#include <cmath>     // For std::pow, std::log, std::sqrt
+#include <cstdlib>   // For std::strtol, std::strtod
+#include <charconv>  // For std::to_chars
+#include <utility>   // For std::swap
+#include <chrono>    // For the planning time budget
+
+// Codec for the Q-table's storage format
+typedef QValueCodec<QValueStorage> StorageCodec;
 
 // Constructor
 QLearningAgent::QLearningAgent()
-    : alpha(0.1), gamma(0.9), epsilon(0.1), // Default to Easy/Medium
-      rng(std::random_device{}()), // Seed the random number generator
-      exploration_distribution(0.0, 1.0),
-      action_distribution(0, NUM_ACTIONS - 1)
+    : QLearningAgent(std::random_device{}()) // Seed the random number generator
 {
     // Set default difficulty (can be changed later)
     set_difficulty(DifficultyLevel::EASY);
 }
 
+// Constructor with a fixed seed (reproducible, silent)
+QLearningAgent::QLearningAgent(unsigned int seed)
+    : q_value_scale(DEFAULT_Q_VALUE_BOUND / 32767.0),
+      alpha(0.1), gamma(0.9), epsilon(0.1), // Easy parameters
+      learning_rate_exponent(0.0), exploration_bonus(0.0), // Fixed alpha, plain epsilon-greedy
+      update_count(0),
+      refine_visits(0),
+      dyna_enabled(false), model_capacity(DEFAULT_MODEL_CAPACITY), model_next(0),
+      planning_updates(0), planning_microseconds(0.0), planning_update_count(0),
+      planning_rng(seed + 1),
+      stay_active(false), stay_key(0), stay_action(0), stay_reward(0.0), stay_discount(1.0),
+      mirror_symmetry(false), mirror_grid_y(GRID_Y_DIVISIONS), mirror_paddle_y(PADDLE_Y_DIVISIONS),
+      action_cache_enabled(true), action_cache_valid(false), cached_key(0), cached_action(0),
+      action_cache_hits(0), action_cache_misses(0),
+      rng(seed),
+      exploration_distribution(0.0, 1.0),
+      action_distribution(0, NUM_ACTIONS - 1)
+{
+    // Size the Q-table for the whole state space up front, so it never grows (or rehashes)
+    // in the middle of a frame. Untouched pages of the table cost no physical memory.
+    q_table.reserve(STATE_SPACE_SIZE);
+}
+
 // Set difficulty parameters
 void QLearningAgent::set_difficulty(DifficultyLevel level) {
     switch (level) {
@@ -41,29 +68,171 @@ void QLearningAgent::set_difficulty(DifficultyLevel level) {
     }
 }
 
+// Set learning parameters directly
+void QLearningAgent::set_parameters(double new_alpha, double new_gamma, double new_epsilon) {
+    alpha = new_alpha;
+    gamma = new_gamma;
+    epsilon = new_epsilon;
+}
+
+// Convert a stored row to double precision
+QValues QLearningAgent::decode_row(const QRow& row) const {
+    QValues q_values;
+    for (int i = 0; i < NUM_ACTIONS; ++i) {
+        q_values[i] = StorageCodec::decode(row[i], q_value_scale);
+    }
+    return q_values;
+}
+
+// Store one Q-value in the table's storage format
+void QLearningAgent::store_q_value(QRow& row, int action_index, double value, std::mt19937& dither_rng) {
+    // Stochastic rounding for the 16-bit formats; float and double don't draw from the RNG
+    double dither = StorageCodec::stochastic ? exploration_distribution(dither_rng) : 0.5;
+    row[action_index] = StorageCodec::encode(value, q_value_scale, dither);
+}
+
+// Count a visit and pick the step size
+double QLearningAgent::next_learning_rate(QRow& row, int action_index) {
+    std::uint16_t& visits = row.visits[action_index];
+    if (visits < MAX_VISIT_COUNT) {
+        visits++;
+    }
+    return learning_rate(row, action_index);
+}
+
+// Step size at the current visit count
+double QLearningAgent::learning_rate(const QRow& row, int action_index) const {
+    if (learning_rate_exponent <= 0.0) {
+        return alpha;
+    }
+    // A planned update can reach a row whose visits were never counted (a coarse row, a loaded one)
+    double n = std::max(1.0, static_cast<double>(row.visits[action_index]));
+    double count_rate = (learning_rate_exponent == 1.0) ? 1.0 / n : std::pow(n, -learning_rate_exponent);
+    return std::max(alpha, count_rate);
+}
+
+// UCB bonus from the visit counts
+double QLearningAgent::ucb_bonus(const QRow& row, int action_index) const {
+    double total = static_cast<double>(row.visits[0]) + row.visits[1] + row.visits[2];
+    return exploration_bonus * std::sqrt(std::log(total + 1.0) / (row.visits[action_index] + 1.0));
+}
+
+// Index of the mirrored action (UP and DOWN swap)
+static int mirror_action_index(int action_index) {
+    return static_cast<int>(mirror_action(static_cast<Action>(action_index)));
+}
+
+// Q-values or visit counts seen from the mirrored frame
+template <typename Values>
+static Values mirror_values(Values values) {
+    std::swap(values[static_cast<int>(Action::UP)], values[static_cast<int>(Action::DOWN)]);
+    return values;
+}
+
+// Visit count of a state-action pair
+int QLearningAgent::get_visit_count(StateKey key, Action action) const {
+    bool mirrored = false;
+    const QRow* row = q_table.find(canonical_key(key, &mirrored));
+    if (mirrored) action = mirror_action(action);
+    return row ? row->visits[static_cast<int>(action)] : 0;
+}
+
+// Change the Fixed16 scale, re-encoding every stored value
+void QLearningAgent::set_q_value_bound(double bound) {
+    double old_scale = q_value_scale;
+    auto re_encode = [old_scale, bound](QTable<QRow>& table) {
+        std::vector<StateKey> keys;
+        keys.reserve(table.size());
+        table.for_each([&keys](StateKey key, const QRow&) { keys.push_back(key); });
+        for (StateKey key : keys) {
+            QRow& row = *table.find(key);
+            for (int i = 0; i < NUM_ACTIONS; ++i) {
+                double value = StorageCodec::decode(row[i], old_scale);
+                row[i] = StorageCodec::encode(value, bound / 32767.0, 0.5);
+            }
+        }
+    };
+    re_encode(q_table);
+    for (QTable<QRow>& table : coarse_tables) {
+        re_encode(table);
+    }
+    q_value_scale = bound / 32767.0;
+    action_cache_valid = false; // Re-rounding may change ties
+}
+
+// Q-values of a known state in double precision
+QValues QLearningAgent::get_q_values(StateKey key) const {
+    bool mirrored = false;
+    const QRow* row = q_table.find(canonical_key(key, &mirrored));
+    if (!row) {
+        return QValues{0.0, 0.0, 0.0};
+    }
+    return mirrored ? mirror_values(decode_row(*row)) : decode_row(*row);
+}
+
+// Overwrite the Q-values of a state
+void QLearningAgent::set_q_values(StateKey key, const QValues& q_values) {
+    bool mirrored = false;
+    key = canonical_key(key, &mirrored);
+    invalidate_cached_action(key);
+    QRow& row = q_table.find_or_insert(key);
+    QValues stored = mirrored ? mirror_values(q_values) : q_values;
+    for (int i = 0; i < NUM_ACTIONS; ++i) {
+        row[i] = StorageCodec::encode(stored[i], q_value_scale, 0.5); // Round to nearest
+    }
+}
+
+// Overwrite a state's Q-values and visit counts
+void QLearningAgent::set_q_values(StateKey key, const QValues& q_values,
+                                  const std::array<std::uint16_t, NUM_ACTIONS>& visits) {
+    bool mirrored = false;
+    key = canonical_key(key, &mirrored);
+    invalidate_cached_action(key);
+    QRow& row = q_table.find_or_insert(key);
+    QValues stored = mirrored ? mirror_values(q_values) : q_values;
+    for (int i = 0; i < NUM_ACTIONS; ++i) {
+        row[i] = StorageCodec::encode(stored[i], q_value_scale, 0.5);
+    }
+    row.visits = mirrored ? mirror_values(visits) : visits;
+}
 
 // Get Q-value, defaulting to 0 if state/action not seen
 double QLearningAgent::get_q_value(const State& state, int action_index) const {
-    auto it = q_table.find(state);
-    if (it != q_table.end()) {
+    bool mirrored = false;
+    const QRow* row = q_table.find(canonical_key(encode_state(state), &mirrored));
+    if (mirrored) action_index = mirror_action_index(action_index);
+    if (row) {
         // State exists, return the Q-value for the specific action
-        return it->second[action_index];
+        return StorageCodec::decode((*row)[action_index], q_value_scale);
     } else {
         // State hasn't been seen before, return default value (usually 0)
         return 0.0;
     }
 }
 
+// Get the index of the best action in a stored row
+int QLearningAgent::best_action_in_row(const QRow& row, bool with_bonus) const {
+    // Find the action with the maximum Q-value (plus exploration bonus, if asked for and enabled)
+    QValues q_values = decode_row(row);
+    if (with_bonus && exploration_bonus > 0.0) {
+        for (int i = 0; i < NUM_ACTIONS; ++i) {
+            q_values[i] += ucb_bonus(row, i);
+        }
+    }
+    // Use std::max_element to find the iterator to the max value
+    auto max_it = std::max_element(q_values.begin(), q_values.end());
+    // Return the index of the max element
+    return static_cast<int>(std::distance(q_values.begin(), max_it));
+}
+
 // Get the index of the best action for a state
 int QLearningAgent::get_best_action_index(const State& state) const {
-    auto it = q_table.find(state);
-    if (it != q_table.end()) {
-        // State exists, find the action with the maximum Q-value
-        const auto& q_values = it->second;
-        // Use std::max_element to find the iterator to the max value
-        auto max_it = std::max_element(q_values.begin(), q_values.end());
-        // Return the index of the max element
-        return static_cast<int>(std::distance(q_values.begin(), max_it));
+    bool mirrored = false;
+    const QRow* found = decision_row(canonical_key(encode_state(state), &mirrored));
+    if (found) {
+        // State exists (its row may be the mirror image's, with UP and DOWN swapped)
+        int best = best_action_in_row(*found, true);
+        return mirrored ? mirror_action_index(best) : best;
     } else {
         // State not seen, return a default action (e.g., STAY or a random one)
         // Returning a random action here might encourage exploration in unknown states.
@@ -72,6 +241,17 @@ int QLearningAgent::get_best_action_index(const State& state) const {
     }
 }
 
+// Greedy action without side effects
+Action QLearningAgent::best_action(const State& state) const {
+    bool mirrored = false;
+    const QRow* found = decision_row(canonical_key(encode_state(state), &mirrored));
+    if (!found) {
+        return Action::STAY;
+    }
+    Action best = static_cast<Action>(best_action_in_row(*found, false));
+    return mirrored ? mirror_action(best) : best;
+}
+
 // Choose action using epsilon-greedy strategy
 Action QLearningAgent::choose_action(const State& current_state) {
     // Generate a random number for exploration check
@@ -82,9 +262,37 @@ Action QLearningAgent::choose_action(const State& current_state) {
     if (random_value < epsilon) {
         // Explore: Choose a random action
         chosen_action_index = action_distribution(rng);
-    } else {
+    } else if (!action_cache_enabled) {
         // Exploit: Choose the best known action for the current state
         chosen_action_index = get_best_action_index(current_state);
+    } else {
+        // Exploit, reusing the last decision while the encoded state is unchanged. The cache
+        // works in the stored frame; decisions are mirrored back into the caller's.
+        bool mirrored = false;
+        StateKey key = canonical_key(encode_state(current_state), &mirrored);
+        if (action_cache_valid && key == cached_key) {
+            chosen_action_index = mirrored ? mirror_action_index(cached_action) : cached_action;
+            action_cache_hits++;
+        } else {
+            action_cache_misses++;
+            bool own_row = true;
+            const QRow* row = decision_row(key, &own_row);
+            if (row) {
+                chosen_action_index = best_action_in_row(*row, true);
+                // A decision that a coarse cell makes, or could still take over, changes whenever
+                // any state in that cell learns, so only the state's own decisions are kept
+                action_cache_valid = own_row;
+                cached_key = key;
+                cached_action = chosen_action_index;
+                if (mirrored) {
+                    chosen_action_index = mirror_action_index(chosen_action_index);
+                }
+            } else {
+                // Unseen state: random action (as in get_best_action_index), which must not be reused
+                chosen_action_index = action_distribution(rng);
+                action_cache_valid = false;
+            }
+        }
     }
 
     return static_cast<Action>(chosen_action_index);
@@ -92,32 +300,530 @@ Action QLearningAgent::choose_action(const State& current_state) {
 
 // Update Q-value using the Q-learning formula
 void QLearningAgent::update_q_value(const State& old_state, Action action, double reward, const State& new_state) {
-    // Get the Q-value for the action taken in the old state
-    int action_index = static_cast<int>(action);
-    double old_q_value = get_q_value(old_state, action_index);
+    update_q_value(old_state, action, reward, new_state, gamma);
+}
 
-    // Find the maximum Q-value for the resulting new state (best possible future reward)
-    double max_future_q = 0.0;
-    auto it_new = q_table.find(new_state);
-    if (it_new != q_table.end()) {
-         max_future_q = *std::max_element(it_new->second.begin(), it_new->second.end());
+// Update Q-value with an explicit discount on the future value
+void QLearningAgent::update_q_value(const State& old_state, Action action, double reward, const State& new_state,
+                                    double discount) {
+    // With mirror symmetry both states are looked up in the stored frame, and the action with
+    // them when the old state's row is its mirror image's. The next state is only maximized over.
+    bool mirrored = false;
+    StateKey old_key = canonical_key(encode_state(old_state), &mirrored);
+    StateKey new_key = canonical_key(encode_state(new_state));
+    int action_index = static_cast<int>(mirrored ? mirror_action(action) : action);
+    if (!coarse_tables.empty()) {
+        hierarchical_update(old_key, action_index, reward, new_key, discount);
+    } else {
+        flat_update(old_key, action_index, reward, new_key, discount);
+    }
+    if (dyna_enabled) {
+        record_transition(old_key, action_index, reward, new_key, discount);
+        plan_after_updates(1);
     }
-    // If new_state is not in q_table, max_future_q remains 0.0, which is correct.
+}
 
-    // Apply the Q-learning update rule:
+// One flat Q-learning update
+void QLearningAgent::flat_update(StateKey old_key, int action_index, double reward, StateKey new_key,
+                                 double discount, bool simulated) {
+    // Find the maximum Q-value for the resulting new state (best possible future reward).
+    // The new state is inserted with zeros if it hasn't been seen, which gives max_future_q = 0.0.
+    // Read it before touching old_state: inserting a row may move the others.
+    QValues next_q_values = decode_row(q_table.find_or_insert(new_key));
+    double max_future_q = *std::max_element(next_q_values.begin(), next_q_values.end());
+
+    // Get the Q-values for the old state, inserting zeros if it is new
+    invalidate_cached_action(old_key);
+    QRow& row = q_table.find_or_insert(old_key);
+    double old_q_value = StorageCodec::decode(row[action_index], q_value_scale);
+
+    // Apply the Q-learning update rule (always in double precision):
     // Q(s, a) = Q(s, a) + alpha * [reward + gamma * max Q(s', a') - Q(s, a)]
-    double new_q_value = old_q_value + alpha * (reward + gamma * max_future_q - old_q_value);
+    // where alpha may depend on how often (s, a) has been updated. A planned update is not an
+    // experience: it leaves the visit count (and so step sizes and the UCB bonus) alone.
+    if (simulated) {
+        double rate = learning_rate(row, action_index);
+        store_q_value(row, action_index, old_q_value + rate * (reward + discount * max_future_q - old_q_value),
+                      planning_rng);
+        return;
+    }
+    double rate = next_learning_rate(row, action_index);
+    store_q_value(row, action_index, old_q_value + rate * (reward + discount * max_future_q - old_q_value), rng);
+    update_count++;
+}
+
+// --- Coarse-to-fine hierarchy ---
+
+// Number of rows a coarse level is reserved for: a level merges 2^level cells on each of the
+// four grid axes
+static size_t coarse_level_capacity(int level) {
+    return std::max<size_t>(STATE_SPACE_SIZE >> (4 * level), 16);
+}
+
+void QLearningAgent::set_coarse_levels(int levels, int new_refine_visits) {
+    levels = std::max(0, std::min(levels, STATE_GRID_BITS - 1));
+    coarse_tables.assign(static_cast<size_t>(levels), QTable<QRow>());
+    for (int level = 1; level <= levels; ++level) {
+        coarse_tables[level - 1].reserve(coarse_level_capacity(level));
+    }
+    refine_visits = std::max(0, new_refine_visits);
+    rebuild_coarse_tables();
+    action_cache_valid = false;
+}
+
+size_t QLearningAgent::memory_bytes() const {
+    size_t bytes = q_table.memory_bytes();
+    for (const QTable<QRow>& table : coarse_tables) {
+        bytes += table.memory_bytes();
+    }
+    if (dyna_enabled) {
+        bytes += model.capacity() * sizeof(ModelTransition);
+    }
+    return bytes;
+}
+
+// Anything learned: a visit, or a non-zero value (tables saved without visit counts)
+bool QLearningAgent::row_learned(const QRow& row) const {
+    for (int i = 0; i < NUM_ACTIONS; ++i) {
+        if (row.visits[i] != 0 || StorageCodec::decode(row[i], q_value_scale) != 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    // Update the Q-table. If old_state is not present, it will be inserted.
-    q_table[old_state][action_index] = new_q_value;
+// Nearest learned ancestor
+const QRow* QLearningAgent::ancestor_row(StateKey key, int first_level) const {
+    for (int level = first_level; level <= static_cast<int>(coarse_tables.size()); ++level) {
+        const QRow* row = coarse_tables[level - 1].find(coarsen_key(key, level));
+        if (row && row_learned(*row)) {
+            return row;
+        }
+    }
+    return nullptr;
+}
+
+// The row a decision (or a bootstrap value) for `key` is read from
+const QRow* QLearningAgent::decision_row(StateKey key, bool* own_row) const {
+    const QRow* row = q_table.find(key);
+    if (coarse_tables.empty() || (row && row_learned(*row))) {
+        if (own_row) *own_row = true;
+        return row; // Without a hierarchy this is exactly the flat lookup
+    }
+    // Otherwise the decision can change as soon as an ancestor learns, even when it comes from
+    // the state's own (unlearned) row
+    if (own_row) *own_row = false;
+    if (const QRow* ancestor = ancestor_row(key, 1)) {
+        return ancestor;
+    }
+    return row;
+}
 
-    // Optional: Ensure the new state exists in the table, initializing its Q-values if not.
-    // This helps if get_best_action_index relies on the state existing.
-    if (q_table.find(new_state) == q_table.end()) {
-        q_table[new_state] = {0.0, 0.0, 0.0}; // Initialize Q-values for the new state
+bool QLearningAgent::estimate_q_values(StateKey key, QValues& q_values) const {
+    bool mirrored = false;
+    const QRow* row = decision_row(canonical_key(key, &mirrored));
+    if (!row) {
+        return false;
+    }
+    q_values = mirrored ? mirror_values(decode_row(*row)) : decode_row(*row);
+    return true;
+}
+
+// One step of Q(row, action) toward the target
+void QLearningAgent::apply_update(QRow& row, int action_index, double target, bool simulated) {
+    double q = StorageCodec::decode(row[action_index], q_value_scale);
+    if (simulated) {
+        store_q_value(row, action_index, q + learning_rate(row, action_index) * (target - q), planning_rng);
+    } else {
+        double rate = next_learning_rate(row, action_index);
+        store_q_value(row, action_index, q + rate * (target - q), rng);
     }
 }
 
+// Update every level toward the same target, coarsest first
+void QLearningAgent::hierarchical_update(StateKey old_key, int action_index, double reward, StateKey new_key,
+                                         double discount, bool simulated) {
+    // The next state is only looked up, never inserted: rows exist only where something was learned
+    double max_future_q = 0.0;
+    if (const QRow* next_row = decision_row(new_key)) {
+        QValues next_q_values = decode_row(*next_row);
+        max_future_q = *std::max_element(next_q_values.begin(), next_q_values.end());
+    }
+    double target = reward + discount * max_future_q;
+
+    // A row learning for the first time starts from its nearest learned ancestor's values
+    auto start_from_ancestor = [this](QRow& row, StateKey key, int first_level) {
+        if (!row_learned(row)) {
+            if (const QRow* ancestor = ancestor_row(key, first_level)) {
+                row.q = ancestor->q;
+            }
+        }
+    };
+
+    int levels = static_cast<int>(coarse_tables.size());
+    for (int level = levels; level >= 1; --level) {
+        QRow& row = coarse_tables[level - 1].find_or_insert(coarsen_key(old_key, level));
+        start_from_ancestor(row, old_key, level + 1);
+        apply_update(row, action_index, target, simulated);
+    }
+
+    if (refine_visits > 0) {
+        const QRow& parent = *coarse_tables[0].find(coarsen_key(old_key, 1));
+        int parent_visits = parent.visits[0] + parent.visits[1] + parent.visits[2];
+        if (parent_visits < refine_visits && !q_table.find(old_key)) {
+            if (!simulated) update_count++;
+            return; // Not refined yet: the coarse levels stand in for this state
+        }
+    }
+    invalidate_cached_action(old_key);
+    QRow& row = q_table.find_or_insert(old_key);
+    start_from_ancestor(row, old_key, 1);
+    apply_update(row, action_index, target, simulated);
+    if (!simulated) update_count++;
+}
+
+// Running visit-weighted sums of one coarse state, while rebuilding a level
+struct CoarseSums {
+    double weighted[NUM_ACTIONS]; // Sum of visits * Q
+    double weight[NUM_ACTIONS];   // Sum of visits
+    double plain[NUM_ACTIONS];    // Sum of Q (for actions without visits)
+    std::uint32_t rows;           // Fine rows merged
+};
+
+// Coarse levels from the finest table
+void QLearningAgent::rebuild_coarse_tables() {
+    for (int level = 1; level <= static_cast<int>(coarse_tables.size()); ++level) {
+        QTable<CoarseSums> sums;
+        q_table.for_each([&](StateKey key, const QRow& row) {
+            if (!row_learned(row)) {
+                return;
+            }
+            QValues q_values = decode_row(row);
+            CoarseSums& sum = sums.find_or_insert(coarsen_key(key, level));
+            for (int i = 0; i < NUM_ACTIONS; ++i) {
+                sum.weighted[i] += row.visits[i] * q_values[i];
+                sum.weight[i] += row.visits[i];
+                sum.plain[i] += q_values[i];
+            }
+            sum.rows++;
+        });
+        QTable<QRow>& table = coarse_tables[level - 1];
+        table.clear();
+        sums.for_each([&](StateKey key, const CoarseSums& sum) {
+            QRow& row = table.find_or_insert(key);
+            for (int i = 0; i < NUM_ACTIONS; ++i) {
+                double value = sum.weight[i] > 0.0 ? sum.weighted[i] / sum.weight[i] : sum.plain[i] / sum.rows;
+                row[i] = StorageCodec::encode(value, q_value_scale, 0.5);
+                row.visits[i] = static_cast<std::uint16_t>(std::min(sum.weight[i], static_cast<double>(MAX_VISIT_COUNT)));
+            }
+        });
+    }
+}
+
+// --- Mirror symmetry ---
+
+// States outside the grid (from a table learned on another grid) have no image in it
+bool QLearningAgent::has_mirror_image(StateKey key) const {
+    return mirror_symmetry &&
+           static_cast<int>((key >> 7) & STATE_GRID_MASK) < mirror_grid_y &&
+           static_cast<int>((key >> 14) & STATE_GRID_MASK) < mirror_paddle_y &&
+           static_cast<int>((key >> 21) & STATE_GRID_MASK) < mirror_paddle_y;
+}
+
+StateKey QLearningAgent::canonical_key(StateKey key, bool* mirrored) const {
+    if (mirrored) *mirrored = false;
+    if (!has_mirror_image(key)) {
+        return key;
+    }
+    StateKey image = mirror_key(key, mirror_grid_y, mirror_paddle_y);
+    if (image < key) {
+        if (mirrored) *mirrored = true;
+        return image;
+    }
+    return key;
+}
+
+void QLearningAgent::merge_row(StateKey key, const QRow& row) {
+    bool mirrored = false;
+    bool inserted = false;
+    key = canonical_key(key, &mirrored);
+    QRow& stored = q_table.find_or_insert(key, &inserted);
+    if (inserted) {
+        stored.q = mirrored ? mirror_values(row.q) : row.q;
+        stored.visits = mirrored ? mirror_values(row.visits) : row.visits;
+        return;
+    }
+    QValues old_q = decode_row(stored);
+    QValues new_q = mirrored ? mirror_values(decode_row(row)) : decode_row(row);
+    std::array<std::uint16_t, NUM_ACTIONS> new_visits = mirrored ? mirror_values(row.visits) : row.visits;
+    for (int i = 0; i < NUM_ACTIONS; ++i) {
+        double old_weight = stored.visits[i];
+        double new_weight = new_visits[i];
+        double share = (old_weight + new_weight > 0.0) ? new_weight / (old_weight + new_weight) : 0.5;
+        // Equal halves (a file saved with symmetry on) keep exactly the value they hold, down to
+        // the sign of a zero
+        if (new_q[i] != old_q[i]) {
+            stored[i] = StorageCodec::encode(old_q[i] + share * (new_q[i] - old_q[i]), q_value_scale, 0.5);
+        }
+        stored.visits[i] = static_cast<std::uint16_t>(
+            std::min<int>(stored.visits[i] + new_visits[i], MAX_VISIT_COUNT)); // Both halves' experience
+    }
+}
+
+void QLearningAgent::set_mirror_symmetry(bool enabled, const Discretization& grid) {
+    // Every known state in the old setting, refolded under the new one
+    std::vector<std::pair<StateKey, QRow>> rows;
+    rows.reserve(mirror_symmetry ? 2 * q_table.size() : q_table.size());
+    for_each_known_state([&rows](StateKey key, const QRow& row) { rows.emplace_back(key, row); });
+
+    mirror_symmetry = enabled;
+    mirror_grid_y = grid.grid_y;
+    mirror_paddle_y = grid.paddle_y;
+    clear_model(); // Its keys were in the old frame
+    q_table.clear();
+    q_table.reserve(rows.size());
+    for (const auto& entry : rows) {
+        merge_row(entry.first, entry.second);
+    }
+    if (!coarse_tables.empty()) {
+        rebuild_coarse_tables();
+    }
+    action_cache_valid = false;
+}
+
+// --- Dyna-Q planning ---
+
+void QLearningAgent::set_dyna_planning(bool enabled, int updates, double microseconds, size_t capacity) {
+    capacity = std::max<size_t>(capacity, 1);
+    if (!enabled || capacity != model_capacity) {
+        clear_model();
+        model.shrink_to_fit();
+    }
+    model_capacity = capacity;
+    if (enabled) {
+        // Allocated whole up front, so recording never reallocates mid-frame (untouched pages of
+        // the ring cost no physical memory)
+        model.reserve(model_capacity);
+    }
+    dyna_enabled = enabled;
+    planning_updates = std::max(0, updates);
+    planning_microseconds = std::max(0.0, microseconds);
+}
+
+void QLearningAgent::record_transition(StateKey key, int action_index, double reward, StateKey next_key,
+                                       double discount) {
+    // As in SemiMdpAccumulator::observe: a stay interrupted by another state ends there, one
+    // interrupted by another action in the same state is dropped (it could only bootstrap from
+    // its own state)
+    if (stay_active && key != stay_key) {
+        store_transition(stay_key, stay_action, stay_reward, key, stay_discount);
+        stay_active = false;
+    } else if (stay_active && action_index != stay_action) {
+        stay_active = false;
+    }
+    if (!stay_active) {
+        stay_active = true;
+        stay_key = key;
+        stay_action = action_index;
+        stay_reward = 0.0;
+        stay_discount = 1.0;
+    }
+    stay_reward += stay_discount * reward;
+    stay_discount *= discount;
+    if (next_key != key) {
+        store_transition(key, action_index, stay_reward, next_key, stay_discount);
+        stay_active = false;
+    }
+}
+
+void QLearningAgent::store_transition(StateKey key, int action_index, double reward, StateKey next_key,
+                                      double discount) {
+    ModelTransition transition;
+    transition.key = key;
+    transition.next = next_key;
+    transition.reward = static_cast<float>(reward);
+    transition.discount = static_cast<float>(discount);
+    transition.action_index = static_cast<std::uint8_t>(action_index);
+    if (model.size() < model_capacity) {
+        model.push_back(transition);
+    } else {
+        model[model_next] = transition; // The oldest
+        model_next = (model_next + 1) % model_capacity;
+    }
+}
+
+void QLearningAgent::plan_after_updates(size_t real_updates) {
+    if (planning_updates > 0 || planning_microseconds > 0.0) {
+        plan(planning_updates * static_cast<int>(real_updates), planning_microseconds * real_updates);
+    }
+}
+
+// Number of simulated updates between two looks at the clock (reading it costs about as much as
+// an update)
+static const int PLANNING_CLOCK_INTERVAL = 8;
+
+int QLearningAgent::plan(int max_updates, double max_microseconds) {
+    if (model.empty() || (max_updates <= 0 && max_microseconds <= 0.0)) {
+        return 0;
+    }
+    typedef std::chrono::steady_clock Clock;
+    const bool timed = max_microseconds > 0.0;
+    const Clock::time_point deadline =
+        timed ? Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>(max_microseconds))
+              : Clock::time_point();
+
+    int done = 0;
+    while (max_updates <= 0 || done < max_updates) {
+        if (timed && done % PLANNING_CLOCK_INTERVAL == 0 && Clock::now() >= deadline) {
+            break;
+        }
+        const ModelTransition& t = model[std::uniform_int_distribution<size_t>(0, model.size() - 1)(planning_rng)];
+        if (!coarse_tables.empty()) {
+            hierarchical_update(t.key, t.action_index, t.reward, t.next, t.discount, true);
+        } else {
+            flat_update(t.key, t.action_index, t.reward, t.next, t.discount, true);
+        }
+        done++;
+    }
+    planning_update_count += done;
+    return done;
+}
+
+// --- Batched API ---
+
+// Number of states processed together by choose_actions. Small enough that the
+// per-block scratch arrays stay in L1, large enough to give the vectorizer full lanes.
+static const size_t ACTION_BATCH_BLOCK = 64;
+
+// Choose actions for many states at once
+void QLearningAgent::choose_actions(const State* states, size_t count, Action* actions) {
+    // Scratch space laid out as one array per action (structure of arrays),
+    // so the argmax below compares whole vectors of Q-values instead of one row at a time.
+    alignas(32) double q0[ACTION_BATCH_BLOCK];
+    alignas(32) double q1[ACTION_BATCH_BLOCK];
+    alignas(32) double q2[ACTION_BATCH_BLOCK];
+    alignas(32) int greedy[ACTION_BATCH_BLOCK];
+    StateKey keys[ACTION_BATCH_BLOCK];
+    bool seen[ACTION_BATCH_BLOCK];
+    bool mirrored[ACTION_BATCH_BLOCK];
+
+    for (size_t base = 0; base < count; base += ACTION_BATCH_BLOCK) {
+        size_t n = std::min(ACTION_BATCH_BLOCK, count - base);
+
+        // 1. Encode the block and prefetch every key's home slot, so the lookups
+        //    below overlap their cache misses instead of paying for them one by one
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = canonical_key(encode_state(states[base + i]), &mirrored[i]);
+            q_table.prefetch(keys[i]);
+        }
+
+        // 2. Look up every state of the block and gather its Q-values (0.0 for unseen states)
+        for (size_t i = 0; i < n; ++i) {
+            const QRow* row = decision_row(keys[i]);
+            seen[i] = (row != nullptr);
+            q0[i] = seen[i] ? StorageCodec::decode((*row)[0], q_value_scale) : 0.0;
+            q1[i] = seen[i] ? StorageCodec::decode((*row)[1], q_value_scale) : 0.0;
+            q2[i] = seen[i] ? StorageCodec::decode((*row)[2], q_value_scale) : 0.0;
+            if (seen[i] && exploration_bonus > 0.0) {
+                q0[i] += ucb_bonus(*row, 0);
+                q1[i] += ucb_bonus(*row, 1);
+                q2[i] += ucb_bonus(*row, 2);
+            }
+        }
+
+        // 3. Branch-free argmax over the block. Strict '>' keeps the first maximum on ties,
+        //    matching std::max_element in get_best_action_index.
+        for (size_t i = 0; i < n; ++i) {
+            double best_q = q0[i];
+            int best = 0;
+            best = (q1[i] > best_q) ? 1 : best;
+            best_q = (q1[i] > best_q) ? q1[i] : best_q;
+            best = (q2[i] > best_q) ? 2 : best;
+            greedy[i] = best;
+        }
+
+        // 4. Epsilon-greedy selection. The random draws happen in the same order as in
+        //    choose_action, so a batch of one behaves exactly like a single call.
+        for (size_t i = 0; i < n; ++i) {
+            double random_value = exploration_distribution(rng);
+            int chosen_action_index;
+            if (random_value < epsilon || !seen[i]) {
+                // Explore, or the state is unseen (get_best_action_index returns a random action)
+                chosen_action_index = action_distribution(rng);
+            } else {
+                chosen_action_index = mirrored[i] ? mirror_action_index(greedy[i]) : greedy[i];
+            }
+            actions[base + i] = static_cast<Action>(chosen_action_index);
+        }
+    }
+}
+
+// Apply many Q-learning updates at once
+void QLearningAgent::update_batch(const Transition* transitions, size_t count) {
+    // Keys and actions in the stored frame (see update_q_value)
+    std::vector<StateKey> old_keys(count);
+    std::vector<StateKey> new_keys(count);
+    std::vector<int> action_indices(count);
+    for (size_t i = 0; i < count; ++i) {
+        bool mirrored = false;
+        old_keys[i] = canonical_key(encode_state(transitions[i].state), &mirrored);
+        new_keys[i] = canonical_key(encode_state(transitions[i].next_state));
+        Action action = transitions[i].action;
+        action_indices[i] = static_cast<int>(mirrored ? mirror_action(action) : action);
+    }
+    if (!coarse_tables.empty()) {
+        // Updates run through several tables and may insert as they go: apply them one by one
+        for (size_t i = 0; i < count; ++i) {
+            hierarchical_update(old_keys[i], action_indices[i], transitions[i].reward, new_keys[i], gamma);
+        }
+    } else {
+        apply_flat_batch(transitions, old_keys, new_keys, action_indices);
+    }
+    if (dyna_enabled) {
+        for (size_t i = 0; i < count; ++i) {
+            record_transition(old_keys[i], action_indices[i], transitions[i].reward, new_keys[i], gamma);
+        }
+        plan_after_updates(count);
+    }
+}
+
+// The flat table's part of update_batch
+void QLearningAgent::apply_flat_batch(const Transition* transitions, const std::vector<StateKey>& old_keys,
+                                      const std::vector<StateKey>& new_keys, const std::vector<int>& action_indices) {
+    size_t count = old_keys.size();
+    // update_q_value always leaves both old_state and new_state in the table, and a missing
+    // row reads as all zeros, so every row can be inserted before any update is applied.
+    for (size_t i = 0; i < count; ++i) {
+        q_table.find_or_insert(old_keys[i]);
+        q_table.find_or_insert(new_keys[i]);
+    }
+
+    // No more insertions from here on, so row pointers stay valid.
+    // Resolve them all (with prefetching) before applying the updates.
+    std::vector<QRow*> old_rows(count);
+    std::vector<QRow*> new_rows(count);
+    for (size_t i = 0; i < count; ++i) {
+        q_table.prefetch(old_keys[i]);
+        q_table.prefetch(new_keys[i]);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        old_rows[i] = q_table.find(old_keys[i]);
+        invalidate_cached_action(old_keys[i]);
+        new_rows[i] = q_table.find(new_keys[i]);
+    }
+
+    // Apply the updates in order so later transitions see earlier results
+    for (size_t i = 0; i < count; ++i) {
+        QValues next_q = decode_row(*new_rows[i]);
+        double max_future_q = std::max(next_q[0], std::max(next_q[1], next_q[2]));
+        int action_index = action_indices[i];
+        double q = StorageCodec::decode((*old_rows[i])[action_index], q_value_scale);
+        double rate = next_learning_rate(*old_rows[i], action_index);
+        store_q_value(*old_rows[i], action_index, q + rate * (transitions[i].reward + gamma * max_future_q - q), rng);
+    }
+    update_count += static_cast<long>(count);
+}
+
 // --- Persistence ---
 
 bool QLearningAgent::save_q_table(const std::string& filename) const {
@@ -127,18 +833,74 @@ bool QLearningAgent::save_q_table(const std::string& filename) const {
         return false;
     }
 
-    // Simple text format: state_components action_q_values
-    for (const auto& pair : q_table) {
-        const State& s = pair.first;
-        const auto& q_values = pair.second;
-        outfile << s.ball_x_grid << " " << s.ball_y_grid << " "
-                << s.ball_vx_category << " " << s.ball_vy_category << " "
-                << s.cpu_paddle_y_grid << " " << s.player_paddle_y_grid << " "
-                << q_values[0] << " " << q_values[1] << " " << q_values[2] << "\n";
-    }
+    // Simple text format: state_components action_q_values action_visit_counts
+    // Values are written with only as many digits as the storage format holds.
+    // Readers that only know the first nine columns ignore the visit counts.
+    // Each line is formatted with std::to_chars (the same text as the stream's %g-style output,
+    // without its per-value locale and formatting overhead) and written in one call.
+    // With mirror symmetry both halves are written, so the file does not depend on the setting.
+    size_t state_count = 0;
+    for_each_known_state([this, &outfile, &state_count](StateKey key, const QRow& row) {
+        State s = decode_state(key);
+        QValues q_values = decode_row(row);
+        int fields[6] = {s.ball_x_grid, s.ball_y_grid, s.ball_vx_category, s.ball_vy_category,
+                         s.cpu_paddle_y_grid, s.player_paddle_y_grid};
+        char line[256];
+        char* end = line + sizeof(line);
+        char* p = line;
+        for (int field : fields) {
+            p = std::to_chars(p, end, field).ptr;
+            *p++ = ' ';
+        }
+        for (int i = 0; i < NUM_ACTIONS; ++i) {
+            p = std::to_chars(p, end, q_values[i], std::chars_format::general, StorageCodec::save_digits).ptr;
+            *p++ = ' ';
+        }
+        for (int i = 0; i < NUM_ACTIONS; ++i) {
+            p = std::to_chars(p, end, row.visits[i]).ptr;
+            *p++ = (i + 1 < NUM_ACTIONS) ? ' ' : '\n';
+        }
+        outfile.write(line, p - line);
+        state_count++;
+    });
 
     outfile.close();
-    std::cout << "Q-table saved to " << filename << " (" << q_table.size() << " states)" << std::endl;
+    std::cout << "Q-table saved to " << filename << " (" << state_count << " states)" << std::endl;
+    return true;
+}
+
+// One line of a saved Q-table, parsed
+struct SavedRow {
+    State state;
+    QValues q_values;
+    long visits[NUM_ACTIONS];
+    bool has_visits;
+};
+
+// Parses "x y vx vy cpu player q0 q1 q2 [n0 n1 n2]" with strtol/strtod (a stringstream per
+// line would cost several times more). Returns false if the state or Q-values are missing.
+static bool parse_saved_row(const char* text, SavedRow& row) {
+    int* fields[6] = {&row.state.ball_x_grid, &row.state.ball_y_grid, &row.state.ball_vx_category,
+                      &row.state.ball_vy_category, &row.state.cpu_paddle_y_grid, &row.state.player_paddle_y_grid};
+    char* end = nullptr;
+    for (int* field : fields) {
+        long value = std::strtol(text, &end, 10);
+        if (end == text) return false;
+        *field = static_cast<int>(value);
+        text = end;
+    }
+    for (int i = 0; i < NUM_ACTIONS; ++i) {
+        row.q_values[i] = std::strtod(text, &end);
+        if (end == text) return false;
+        text = end;
+    }
+    // Visit counts are optional (files saved before they existed have none)
+    row.has_visits = true;
+    for (int i = 0; i < NUM_ACTIONS && row.has_visits; ++i) {
+        row.visits[i] = std::strtol(text, &end, 10);
+        row.has_visits = (end != text);
+        text = end;
+    }
     return true;
 }
 
@@ -149,30 +911,45 @@ bool QLearningAgent::load_q_table(const std::string& filename) {
         return false; // Indicate failure, maybe start with empty table
     }
 
-    q_table.clear(); // Clear existing table before loading
+    // Parse everything first, so the table can be sized once. Saved tables list their states in
+    // slot order, and inserting keys in hash order into a table that is still growing piles them
+    // into long probe runs (several times slower on large tables).
+    std::vector<SavedRow> rows;
     std::string line;
-    int lines_read = 0;
     int errors = 0;
-
     while (std::getline(infile, line)) {
-        std::stringstream ss(line);
-        State s;
-        std::array<double, NUM_ACTIONS> q_values;
-
-        if (ss >> s.ball_x_grid >> s.ball_y_grid
-               >> s.ball_vx_category >> s.ball_vy_category
-               >> s.cpu_paddle_y_grid >> s.player_paddle_y_grid
-               >> q_values[0] >> q_values[1] >> q_values[2])
-        {
-            q_table[s] = q_values;
-            lines_read++;
+        SavedRow row;
+        if (parse_saved_row(line.c_str(), row) && state_fits_key(row.state)) {
+            rows.push_back(row);
         } else {
             std::cerr << "Warning: Could not parse line in Q-table file: " << line << std::endl;
             errors++;
         }
     }
-
     infile.close();
-    std::cout << "Q-table loaded from " << filename << " (" << lines_read << " states loaded, " << errors << " errors)" << std::endl;
+
+    q_table.clear(); // Clear existing table before loading
+    clear_model();   // The model described the old table's experience
+    action_cache_valid = false;
+    q_table.reserve(rows.size());
+    for (const SavedRow& saved : rows) {
+        QRow row = QRow();
+        for (int i = 0; i < NUM_ACTIONS; ++i) {
+            row[i] = StorageCodec::encode(saved.q_values[i], q_value_scale, 0.5); // Round to nearest
+        }
+        if (saved.has_visits) {
+            for (int i = 0; i < NUM_ACTIONS; ++i) {
+                row.visits[i] = static_cast<std::uint16_t>(std::max(0L, std::min<long>(saved.visits[i], MAX_VISIT_COUNT)));
+            }
+        }
+        // With mirror symmetry, a state and its image fold into one row
+        merge_row(encode_state(saved.state), row);
+    }
+
+    if (!coarse_tables.empty()) {
+        rebuild_coarse_tables();
+    }
+
+    std::cout << "Q-table loaded from " << filename << " (" << rows.size() << " states loaded, " << errors << " errors)" << std::endl;
     return true;
 }
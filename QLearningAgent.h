@@ -2,11 +2,15 @@
 #define PONG_QLEARNINGAGENT_H
 
 #include "State.h"
-#include <unordered_map>
+#include "QTable.h"
+#include "QValueStorage.h"
 #include <vector>
 #include <array>
 #include <random>
 #include <string> // For saving/loading
+#include <cstddef> // For size_t
+#include <cstdint> // For uint16_t
+#include <utility> // For std::swap
 
 // Define the possible actions the agent can take.
 enum class Action {
@@ -18,6 +22,49 @@ enum class Action {
 // Number of possible actions.
 const int NUM_ACTIONS = 3;
 
+// The action that mirrors `action` under a vertical flip of the field: UP and DOWN swap.
+inline Action mirror_action(Action action) {
+    return action == Action::UP ? Action::DOWN : action == Action::DOWN ? Action::UP : action;
+}
+
+// The Q-values of one state, indexed by action.
+typedef std::array<double, NUM_ACTIONS> QValues;
+
+// One Q-table row as stored: the Q-values in the build's storage format (see QValueStorage.h),
+// plus how many times each action's value has been updated. Counts saturate at 65535, by which
+// point the count-based schedules below have long since settled.
+struct QRow {
+    std::array<QValueStorage, NUM_ACTIONS> q;
+    std::array<std::uint16_t, NUM_ACTIONS> visits;
+
+    QValueStorage& operator[](int action_index) { return q[action_index]; }
+    const QValueStorage& operator[](int action_index) const { return q[action_index]; }
+};
+
+// Largest visit count a row can hold.
+const std::uint16_t MAX_VISIT_COUNT = 65535;
+
+// One transition remembered by the Dyna-Q model (see QLearningAgent::set_dyna_planning), with
+// keys and action in the Q-table's stored frame.
+struct ModelTransition {
+    StateKey key;
+    StateKey next;
+    float reward;
+    float discount; // Weight of the next state's value
+    std::uint8_t action_index;
+};
+
+// Transitions the Dyna-Q model holds by default (5 MB; over an hour of play in the game).
+const size_t DEFAULT_MODEL_CAPACITY = 1 << 18;
+
+// A single observed transition (s, a, r, s'), used by the batched update API.
+struct Transition {
+    State state;
+    Action action = Action::STAY;
+    double reward = 0.0;
+    State next_state;
+};
+
 // Difficulty levels for the AI.
 enum class DifficultyLevel {
     EASY,
@@ -25,20 +72,79 @@ enum class DifficultyLevel {
     HARD
 };
 
+// Which learning agent plays a paddle (the game's options menu, the training tools).
+enum class AgentKind {
+    QTable,     // Tabular Q-learning over the discretized State (QLearningAgent)
+    TileCoding, // Linear Q-learning over tile-coded Observations (TileCodingAgent)
+    Linear,     // Linear Q-learning over continuous features (LinearAgent)
+    Dqn         // Deep Q-learning with a small neural network (DqnAgent)
+};
+
 class QLearningAgent {
 private:
-    // The Q-table mapping State to an array of Q-values for each action.
-    std::unordered_map<State, std::array<double, NUM_ACTIONS>> q_table;
+    // The Q-table mapping the packed State key to an array of Q-values for each action.
+    QTable<QRow> q_table;
+    double q_value_scale; // Per-table scale of the Fixed16 storage format (unused by the others)
 
     // Learning parameters
     double alpha;   // Learning rate (how much new information overrides old)
     double gamma;   // Discount factor (importance of future rewards)
     double epsilon; // Exploration rate (probability of choosing a random action)
 
+    // Count-based schedules (both off by default; see the setters below)
+    double learning_rate_exponent; // Step size for the n-th update of (s, a) is max(alpha, n^-exponent)
+    double exploration_bonus;      // UCB weight c added to Q-values when choose_action exploits
+
+    long update_count; // Q-value updates applied so far
+
+    // Coarse-to-fine hierarchy (empty unless set_coarse_levels was called)
+    std::vector<QTable<QRow>> coarse_tables; // coarse_tables[l - 1] holds level l (see coarsen_key)
+    int refine_visits; // A state gets its own row once its level-1 cell has been updated this often
+
+    // Dyna-Q planning (off unless set_dyna_planning was called)
+    bool dyna_enabled;
+    std::vector<ModelTransition> model; // Ring of the latest transitions
+    size_t model_capacity;             // Transitions the ring holds
+    size_t model_next;                 // Slot the next transition overwrites once the ring is full
+    int planning_updates;              // Simulated updates after each real one
+    double planning_microseconds;      // Time limit on them per real update (0 = none)
+    long planning_update_count;        // Simulated updates applied so far
+    std::mt19937 planning_rng;         // Separate, so planning leaves the exploration sequence alone
+                                       // (it also dithers the planned updates' rounding)
+
+    // The stay being recorded: consecutive transitions of one state-action pair back into the
+    // same state, folded into one (as SemiMdpAccumulator does for the real updates)
+    bool stay_active;
+    StateKey stay_key;
+    int stay_action;
+    double stay_reward;   // Rewards so far, each discounted by the transitions before it
+    double stay_discount; // Product of the discounts so far
+
+    // Mirror symmetry (off unless set_mirror_symmetry was called)
+    bool mirror_symmetry;
+    int mirror_grid_y;   // Ball rows of the grid the states are mirrored in
+    int mirror_paddle_y; // Paddle rows of that grid
+
+    // Action cache: the greedy decision for the last state choose_action exploited in.
+    // The greedy action only changes when the state changes or that state's row is updated,
+    // so repeated frames in the same state skip the table lookup.
+    bool action_cache_enabled;
+    bool action_cache_valid;
+    StateKey cached_key;   // State of the cached decision
+    int cached_action;     // Greedy action index for cached_key
+    long action_cache_hits;
+    long action_cache_misses;
+
+    // Drops the cached decision if it belongs to `key` (its row is about to change).
+    void invalidate_cached_action(StateKey key) {
+        if (action_cache_valid && cached_key == key) action_cache_valid = false;
+    }
+
     // Random number generation for exploration
-    std::mt19937 rng; // Mersenne Twister random number generator
+    // Mutable so that const lookups (get_best_action_index) can pick a random action for unseen states.
+    mutable std::mt19937 rng; // Mersenne Twister random number generator
     std::uniform_real_distribution<double> exploration_distribution; // For epsilon check
-    std::uniform_int_distribution<int> action_distribution; // For choosing random action
+    mutable std::uniform_int_distribution<int> action_distribution; // For choosing random action
 
     // Helper function to get the Q-value for a given state and action.
     // Returns 0.0 if the state or state-action pair hasn't been seen yet.
@@ -46,25 +152,167 @@ private:
 
     // Helper function to find the action with the highest Q-value for a given state.
     // Returns the index of the best action. Handles ties arbitrarily (e.g., first max).
+    // This is choose_action's exploit step, so it includes the exploration bonus.
     int get_best_action_index(const State& state) const;
 
+    // Index of the best action in a stored row (first maximum on ties). `with_bonus` adds the
+    // UCB exploration bonus, which only choose_action and choose_actions ask for: best_action
+    // stays on plain Q, like the GreedyPolicy compiled from the same table.
+    int best_action_in_row(const QRow& row, bool with_bonus) const;
+
+    // Converts a stored row to double precision.
+    QValues decode_row(const QRow& row) const;
+
+    // Stores `value` into one entry of a row, rounding stochastically for 16-bit formats (with
+    // dither drawn from `dither_rng`).
+    void store_q_value(QRow& row, int action_index, double value, std::mt19937& dither_rng);
+
+    // Step size for (row, action) at its current visit count.
+    double learning_rate(const QRow& row, int action_index) const;
+
+    // Counts one more update of (row, action) and returns the step size to use for it.
+    double next_learning_rate(QRow& row, int action_index);
+
+    // UCB exploration bonus of an action: c * sqrt(ln(N + 1) / (n + 1)), where N is the
+    // state's total visit count and n the action's.
+    double ucb_bonus(const QRow& row, int action_index) const;
+
+    // --- Hierarchy helpers ---
+    // True if a row holds anything learned (an update, or values loaded from a file). Rows of
+    // zeros are placeholders, e.g. next states inserted by the flat update.
+    bool row_learned(const QRow& row) const;
+
+    // Nearest learned row of `key`'s ancestors at levels first_level and up, or nullptr.
+    const QRow* ancestor_row(StateKey key, int first_level) const;
+
+    // The row that decides for `key`: its own row if learned, otherwise (with coarse levels) the
+    // nearest learned ancestor, otherwise its own row or nullptr. `own_row` tells whether the
+    // decision is the state's own for good: false whenever a coarse level could still take over.
+    const QRow* decision_row(StateKey key, bool* own_row = nullptr) const;
+
+    // Moves Q(row, action) toward `target`, counting the visit unless `simulated`.
+    void apply_update(QRow& row, int action_index, double target, bool simulated);
+
+    // Update through the hierarchy: the ancestors at every level, then the state's own row.
+    // A `simulated` (planned) update counts no visits and no update, and draws from planning_rng.
+    void hierarchical_update(StateKey old_key, int action_index, double reward, StateKey new_key, double discount,
+                             bool simulated = false);
+
+    // Recomputes every coarse level from the finest table (visit-weighted means).
+    void rebuild_coarse_tables();
+
+    // One Q-learning update of the flat table, on keys in the stored frame (`simulated` as for
+    // hierarchical_update).
+    void flat_update(StateKey old_key, int action_index, double reward, StateKey new_key, double discount,
+                     bool simulated = false);
+
+    // update_batch on the flat table: every row resolved up front, then the updates in order.
+    void apply_flat_batch(const Transition* transitions, const std::vector<StateKey>& old_keys,
+                          const std::vector<StateKey>& new_keys, const std::vector<int>& action_indices);
+
+    // --- Dyna-Q helpers ---
+    // Feeds a real transition (stored frame) to the model. Transitions back into the same state
+    // are folded into the stay; the stay is stored once it leaves the state (or the next
+    // transition starts elsewhere), and dropped if the action changes within the state.
+    void record_transition(StateKey key, int action_index, double reward, StateKey next_key, double discount);
+
+    // Stores one transition in the model's ring.
+    void store_transition(StateKey key, int action_index, double reward, StateKey next_key, double discount);
+
+    // Forgets the model (and the stay being recorded).
+    void clear_model() {
+        model.clear();
+        model_next = 0;
+        stay_active = false;
+    }
+
+    // Plans within the configured budget for `real_updates` real updates.
+    void plan_after_updates(size_t real_updates);
+
+    // --- Mirror symmetry helpers ---
+    // True if mirror symmetry is on and `key` lies inside the mirrored grid.
+    bool has_mirror_image(StateKey key) const;
+
+    // The key a state is stored under: with mirror symmetry, the smaller of its key and its
+    // mirror image's. `mirrored` tells whether that was the image (so actions must be mirrored).
+    StateKey canonical_key(StateKey key, bool* mirrored = nullptr) const;
+
+    // Stores a state's row under its canonical key, merging it with what is already there (the
+    // mirror image's row): visit-weighted mean values, the summed visit counts (saturating).
+    void merge_row(StateKey key, const QRow& row);
+
 public:
     // Constructor: Initializes parameters and random number generator.
     QLearningAgent();
 
+    // Constructor with a fixed random seed, for reproducible headless training.
+    // Starts with the EASY parameters without printing them.
+    explicit QLearningAgent(unsigned int seed);
+
     // Sets the AI difficulty by adjusting learning parameters.
     void set_difficulty(DifficultyLevel level);
 
+    // Sets alpha, gamma and epsilon directly (e.g. from a training tool's command line).
+    void set_parameters(double new_alpha, double new_gamma, double new_epsilon);
+
+    // Count-based learning rate. With `exponent` > 0, the n-th update of a state-action pair uses
+    // step size max(alpha, 1 / n^exponent): rarely visited pairs learn quickly from their first
+    // samples, and frequently visited ones settle to alpha. Exponent 1 with alpha 0 is the classic
+    // 1/n schedule; values in (0.5, 1) are the polynomial schedules. 0 (the default) keeps alpha fixed:
+    // against the scripted opponent no exponent reached the win threshold measurably sooner (see ReadMe).
+    void set_learning_rate_exponent(double exponent) { learning_rate_exponent = exponent; }
+    double get_learning_rate_exponent() const { return learning_rate_exponent; }
+
+    // Count-based exploration. With `bonus` c > 0, choose_action exploits by maximizing
+    // Q(s, a) + c * sqrt(ln(N(s) + 1) / (n(s, a) + 1)) instead of Q(s, a), steering the agent
+    // toward actions it has rarely tried in that state. best_action ignores the bonus. 0 (the default) turns it off: with the
+    // movement penalty in the reward, the bonus slows learning down (see ReadMe).
+    void set_exploration_bonus(double bonus) { exploration_bonus = bonus; action_cache_valid = false; }
+    double get_exploration_bonus() const { return exploration_bonus; }
+
+    // Number of updates applied to a state-action pair (0 if unseen).
+    int get_visit_count(StateKey key, Action action) const;
+
+    // Re-seeds the exploration and planning random number generators (e.g. after copying an agent).
+    void seed(unsigned int seed) { rng.seed(seed); planning_rng.seed(seed + 1); }
+
     // Chooses an action based on the current state using the epsilon-greedy strategy.
     // Explores (random action) with probability epsilon, otherwise exploits (best known action).
     Action choose_action(const State& current_state);
 
+    // Greedy action (no exploration, no action cache, first maximum on ties). States never seen
+    // get Action::STAY, like a compiled GreedyPolicy, so the result is deterministic and the call
+    // can be shared by threads.
+    Action best_action(const State& state) const;
+
     // Updates the Q-value for the state-action pair that led from old_state to new_state.
     // This is the core Q-learning update rule.
     void update_q_value(const State& old_state, Action action, double reward, const State& new_state);
 
+    // Same update with an explicit discount for the future value instead of gamma, for transitions
+    // that span more than one step (see SemiMdp.h): Q(s, a) += rate * [reward + discount * max Q(s', .) - Q(s, a)].
+    void update_q_value(const State& old_state, Action action, double reward, const State& new_state,
+                        double discount);
+
+    // --- Batched API (vectorized environments, batch evaluation) ---
+    // Chooses an action for each of the `count` states, writing the results to `actions`.
+    // Same epsilon-greedy semantics (and random number sequence) as calling choose_action per state,
+    // but the lookups are done up front and the argmax runs over whole blocks of states at once.
+    void choose_actions(const State* states, size_t count, Action* actions);
+    void choose_actions(const std::vector<State>& states, std::vector<Action>& actions) {
+        actions.resize(states.size());
+        choose_actions(states.data(), states.size(), actions.data());
+    }
+
+    // Applies the Q-learning update for each transition, in order.
+    // Equivalent to calling update_q_value for each one, but resolves every table row once up front.
+    void update_batch(const Transition* transitions, size_t count);
+    void update_batch(const std::vector<Transition>& transitions) {
+        update_batch(transitions.data(), transitions.size());
+    }
+
     // --- Optional: Persistence ---
-    // Saves the current Q-table to a file.
+    // Saves the current Q-table (with visit counts) to a file.
     bool save_q_table(const std::string& filename) const;
     // Loads a Q-table from a file.
     bool load_q_table(const std::string& filename);
@@ -74,8 +322,156 @@ public:
     double get_gamma() const { return gamma; }
     double get_epsilon() const { return epsilon; }
 
+    // --- Action cache ---
+    // choose_action remembers the greedy action of the last state it exploited in and reuses it
+    // while the encoded state stays the same. Exploration ticks still draw a random action, and
+    // any change to the cached state's row drops the entry, so the choices (and the random number
+    // sequence) are exactly those of an uncached agent. States never seen are not cached (their
+    // "greedy" action is random). Enabled by default.
+    void set_action_cache_enabled(bool enabled) { action_cache_enabled = enabled; action_cache_valid = false; }
+    long get_action_cache_hits() const { return action_cache_hits; }
+    long get_action_cache_misses() const { return action_cache_misses; }
+    void reset_action_cache_stats() { action_cache_hits = 0; action_cache_misses = 0; }
+
+    // Number of Q-value updates applied since construction (real ones; planned updates are
+    // counted by get_planning_update_count).
+    long get_update_count() const { return update_count; }
+
     // Get the number of states explored (size of the Q-table)
     size_t get_explored_state_count() const { return q_table.size(); }
+
+    // Pre-allocates room for `state_count` states so the Q-table does not grow while learning.
+    void reserve(size_t state_count) { q_table.reserve(state_count); }
+
+    // Bytes used by the Q-table, any coarse levels and the Dyna-Q model.
+    size_t memory_bytes() const;
+
+    // --- Coarse-to-fine hierarchy ---
+    // With `levels` > 0 the agent also learns on `levels` coarser grids, level l merging 2^l
+    // cells per grid axis (see coarsen_key). Every update moves the state's cell at each level
+    // toward the same target. A state with nothing learned in its own row is valued by its
+    // nearest learned ancestor: for its greedy action (instead of a random one) and as a next
+    // state (instead of 0). A state's own row starts from that estimate on its first update.
+    // With `refine_visits` > 0 a state only gets its own row once its level-1 cell has been
+    // updated that many times; until then only the coarse levels learn, so rarely visited
+    // regions cost no fine rows. Only the finest table is saved; the coarse levels are rebuilt
+    // from it on load (and by this call). Levels 0 (the default) turns the hierarchy off.
+    void set_coarse_levels(int levels, int refine_visits = 0);
+    int get_coarse_levels() const { return static_cast<int>(coarse_tables.size()); }
+    int get_refine_visits() const { return refine_visits; }
+
+    // Coarse states stored at level l (1 = the first coarse level).
+    size_t get_coarse_state_count(int level) const { return coarse_tables[level - 1].size(); }
+
+    // Q-values the agent acts on in a state: its own row's, or with coarse levels the nearest
+    // learned ancestor's. False (and `q_values` untouched) if there are none.
+    bool estimate_q_values(StateKey key, QValues& q_values) const;
+
+    // --- Dyna-Q planning ---
+    // With Dyna-Q on, every real transition is also recorded in a model: a ring of the latest
+    // `capacity` transitions (20 bytes each). As in semi-MDP learning (SemiMdp.h), transitions
+    // back into the same state are folded together first, so the model remembers where a stay
+    // in a state led and after how much discount, not each frame of it. Planning draws
+    // transitions uniformly from the ring and applies the ordinary update (through the hierarchy,
+    // if any) as if each had just happened again, so values keep propagating between the
+    // (expensive) real steps. Drawing transitions rather than states replays each state-action
+    // pair as often as it was experienced, with the spread of outcomes it had; a model keeping
+    // one outcome per pair replays a rarely seen pair's few outcomes over and over.
+    // After each real update the agent plans within the budget set here: up to `updates`
+    // simulated updates, and with `microseconds` > 0 for no longer than that (0 updates with a
+    // time limit: as many as fit). Both 0 only records, for callers that plan() in their own idle
+    // time (the game, between frames). The model is not saved; loading a table, clearing it or
+    // changing the mirror symmetry drops it.
+    void set_dyna_planning(bool enabled, int updates = 0, double microseconds = 0.0,
+                           size_t capacity = DEFAULT_MODEL_CAPACITY);
+    bool get_dyna_enabled() const { return dyna_enabled; }
+    int get_planning_updates() const { return planning_updates; }
+    double get_planning_microseconds() const { return planning_microseconds; }
+
+    // Applies simulated updates from the model until `max_updates` are done (0 = no limit) or
+    // `max_microseconds` have passed (0 = no limit); with both 0 it does nothing. Returns the
+    // number applied (0 without a model).
+    int plan(int max_updates, double max_microseconds = 0.0);
+
+    // Ends the transition being recorded without storing it. Call it where the experience breaks
+    // off (a reset, a pause in learning), or the next update would be recorded as its successor.
+    void end_transition() { stay_active = false; }
+
+    // Simulated updates applied so far.
+    long get_planning_update_count() const { return planning_update_count; }
+    // Transitions in the model.
+    size_t get_model_size() const { return model.size(); }
+
+    // --- Mirror symmetry ---
+    // Pong is symmetric under a vertical flip: mirroring the ball's row and y velocity and both
+    // paddle rows (see mirror_key) and swapping UP and DOWN gives an equivalent state. With
+    // symmetry on, a state and its mirror image share one row, stored under the smaller key with
+    // the actions of that frame, so the table holds about half the states and every update trains
+    // both. All the calls taking a State or a key still work in the caller's frame; only
+    // get_q_table() shows the stored half. `grid` is the discretization the states come from
+    // (states outside it are stored as they are). Saved files hold both halves, so they load into
+    // agents with or without symmetry. Turning it on folds the learned states together (as the
+    // load does); turning it off expands them again.
+    void set_mirror_symmetry(bool enabled, const Discretization& grid = Discretization());
+    bool get_mirror_symmetry() const { return mirror_symmetry; }
+
+    // Sets the largest |Q| the Fixed16 storage format can represent (re-encoding stored values).
+    void set_q_value_bound(double bound);
+
+    // Read-only access to the Q-table (for analysis tools). With mirror symmetry it holds one
+    // state of each mirrored pair; for_each_known_state lists both.
+    const QTable<QRow>& get_q_table() const { return q_table; }
+
+    // Calls f(key, row) for every state the agent knows, each in its own frame: the stored rows,
+    // and with mirror symmetry also their mirror images (UP and DOWN swapped). A shared row's
+    // visits are split between the two halves, so they add up to the row's (and merge_row sums
+    // them back to exactly the same counts).
+    template <typename F>
+    void for_each_known_state(F f) const {
+        q_table.for_each([this, &f](StateKey key, const QRow& row) {
+            if (!has_mirror_image(key)) {
+                f(key, row);
+                return;
+            }
+            // A stored key is canonical: its image is itself or a larger key that is not stored
+            StateKey image = mirror_key(key, mirror_grid_y, mirror_paddle_y);
+            if (image == key) {
+                f(key, row);
+                return;
+            }
+            QRow own_row = row;
+            QRow image_row = row;
+            for (int a = 0; a < NUM_ACTIONS; ++a) {
+                own_row.visits[a] = static_cast<std::uint16_t>(row.visits[a] - row.visits[a] / 2);
+                image_row.visits[a] = static_cast<std::uint16_t>(row.visits[a] / 2);
+            }
+            f(key, own_row);
+            std::swap(image_row.q[1], image_row.q[2]);
+            std::swap(image_row.visits[1], image_row.visits[2]);
+            f(image, image_row);
+        });
+    }
+
+    // Q-values of a known state in double precision (all zeros if unseen).
+    QValues get_q_values(StateKey key) const;
+    // Q-values of a row of get_q_table() in double precision.
+    QValues get_q_values(const QRow& row) const { return decode_row(row); }
+
+    // Overwrites (or inserts) the Q-values of a state, e.g. to initialize the table from elsewhere
+    // (with mirror symmetry, its image's too). Coarse levels are not touched (set_coarse_levels
+    // rebuilds them).
+    void set_q_values(StateKey key, const QValues& q_values);
+    // Same, also setting the state's visit counts.
+    void set_q_values(StateKey key, const QValues& q_values, const std::array<std::uint16_t, NUM_ACTIONS>& visits);
+
+    // Removes every state from the Q-table, the coarse levels and the Dyna-Q model (keeping their
+    // allocations and the learning parameters).
+    void clear_q_table() {
+        q_table.clear();
+        for (QTable<QRow>& table : coarse_tables) table.clear();
+        clear_model();
+        action_cache_valid = false;
+    }
 };
 
 #endif // PONG_QLEARNINGAGENT_H
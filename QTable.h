@@ -0,0 +1,332 @@
+#ifndef PONG_QTABLE_H
+#define PONG_QTABLE_H
+
+#include "State.h"
+#include <cstddef> // For size_t
+#include <cstdint> // For uint16_t
+#include <cstdlib> // For std::calloc, std::free
+#include <cstring> // For std::memcpy
+#include <memory>  // For std::unique_ptr
+#include <new>     // For std::bad_alloc
+#include <type_traits> // For std::is_trivially_copyable
+#include <utility> // For std::swap
+
+// Prefetch hint for the slot a key will probe first (no-op on compilers without the builtin)
+#if defined(__GNUC__) || defined(__clang__)
+#define PONG_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PONG_PREFETCH(address) ((void)(address))
+#endif
+
+// Open-addressing hash table from packed StateKeys to a per-state Row (e.g. the Q-values),
+// stored inline in one flat array. Collisions are resolved with Robin Hood linear probing:
+// an entry that is further from its home slot takes the place of one that is closer, which
+// keeps probe sequences short even at high load.
+//
+// Growth is incremental so that no single insertion pays for a full rehash: when the table
+// fills up, a table of twice the size is allocated (zeroed lazily by the OS via calloc) and the
+// old slots are migrated a few at a time by each following find_or_insert. Until migration
+// finishes, lookups check the new slots first and then the old ones. Calling reserve() up front
+// (e.g. with the size of the state space) avoids growth entirely.
+//
+// There is no erase (the Q-table only ever grows). Rows are value-initialized on insertion.
+// Pointers and references to rows are invalidated by any insertion.
+template <typename Row>
+class QTable {
+private:
+    struct Slot {
+        StateKey key;
+        std::uint16_t distance; // Probe distance + 1; 0 marks an empty slot
+        Row row;
+    };
+    // Slots are allocated with calloc (all-zero bytes = empty slot) and copied with memcpy
+    static_assert(std::is_trivially_copyable<Slot>::value, "QTable rows must be trivially copyable");
+
+    struct FreeDeleter {
+        void operator()(Slot* p) const { std::free(p); }
+    };
+    typedef std::unique_ptr<Slot[], FreeDeleter> SlotArray;
+
+    // Old slots migrated per find_or_insert while growing. Growth starts at 7/8 load and the
+    // new table can absorb 7/8 of the old capacity more before growing again, so migration
+    // always finishes long before the next growth.
+    static const size_t MIGRATION_STEP = 16;
+
+    SlotArray slots;          // Current table (capacity is zero or a power of two)
+    size_t slot_count;        // Capacity of `slots`
+    SlotArray old_slots;      // Previous table still being migrated (null when not growing)
+    size_t old_slot_count;    // Capacity of `old_slots`
+    size_t migrate_index;     // Old slots below this index have been migrated
+    size_t count;             // Number of distinct keys stored (in either table)
+    size_t grow_threshold;    // Grow when count would exceed this (7/8 of capacity)
+
+    static SlotArray allocate(size_t capacity) {
+        Slot* memory = static_cast<Slot*>(std::calloc(capacity, sizeof(Slot)));
+        if (!memory) throw std::bad_alloc();
+        return SlotArray(memory);
+    }
+
+    static size_t home_slot(StateKey key, size_t capacity) { return StateKeyHash{}(key) & (capacity - 1); }
+
+    // Robin Hood search in one slot array; returns nullptr if absent.
+    static Slot* probe(Slot* table, size_t capacity, StateKey key) {
+        if (capacity == 0) return nullptr;
+        size_t mask = capacity - 1;
+        size_t index = home_slot(key, capacity);
+        for (std::uint16_t distance = 1; ; ++distance) {
+            Slot& slot = table[index];
+            // An empty slot, or a resident closer to home than we would be, ends the search
+            if (slot.distance < distance) return nullptr;
+            if (slot.key == key) return &slot;
+            index = (index + 1) & mask;
+        }
+    }
+
+    // Robin Hood insertion of `carried` into `slots`, starting at `index` (where carried.distance
+    // must already match). Used for keys known to be absent from `slots`.
+    void carry_forward(Slot carried, size_t index) {
+        size_t mask = slot_count - 1;
+        while (true) {
+            Slot& slot = slots[index];
+            if (slot.distance == 0) {
+                slot = carried;
+                return;
+            }
+            if (slot.distance < carried.distance) {
+                // The resident is closer to home than we are: take its place and carry it onward
+                std::swap(slot, carried);
+            }
+            index = (index + 1) & mask;
+            carried.distance++;
+        }
+    }
+
+    // Moves up to `budget` old slots into the current table.
+    void migrate(size_t budget) {
+        size_t end = migrate_index + budget;
+        if (end > old_slot_count) end = old_slot_count;
+        for (; migrate_index < end; ++migrate_index) {
+            const Slot& slot = old_slots[migrate_index];
+            // Skip empty slots and keys already pulled forward by find_or_insert
+            if (slot.distance != 0 && !probe(slots.get(), slot_count, slot.key)) {
+                carry_forward(Slot{slot.key, 1, slot.row}, home_slot(slot.key, slot_count));
+            }
+        }
+        if (migrate_index == old_slot_count) {
+            old_slots.reset();
+            old_slot_count = 0;
+            migrate_index = 0;
+        }
+    }
+
+    // Starts growing into a table of `new_capacity` slots (a power of two).
+    void begin_growth(size_t new_capacity) {
+        if (old_slots) {
+            migrate(old_slot_count); // Never hold more than two tables
+        }
+        old_slots = std::move(slots);
+        old_slot_count = slot_count;
+        migrate_index = 0;
+        slots = allocate(new_capacity);
+        slot_count = new_capacity;
+        grow_threshold = new_capacity - new_capacity / 8;
+        if (old_slot_count == 0) {
+            old_slots.reset();
+        }
+    }
+
+public:
+    QTable()
+        : slot_count(0), old_slot_count(0), migrate_index(0), count(0), grow_threshold(0) {}
+
+    // Copies are flat memcpys of the slot arrays (cheap enough to clone whole tables).
+    QTable(const QTable& other)
+        : slot_count(other.slot_count), old_slot_count(other.old_slot_count),
+          migrate_index(other.migrate_index), count(other.count), grow_threshold(other.grow_threshold)
+    {
+        if (slot_count) {
+            slots = allocate(slot_count);
+            std::memcpy(slots.get(), other.slots.get(), slot_count * sizeof(Slot));
+        }
+        if (old_slot_count) {
+            old_slots = allocate(old_slot_count);
+            std::memcpy(old_slots.get(), other.old_slots.get(), old_slot_count * sizeof(Slot));
+        }
+    }
+
+    QTable& operator=(const QTable& other) {
+        if (this != &other) {
+            QTable copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    QTable(QTable&& other) noexcept : QTable() { swap(other); }
+
+    QTable& operator=(QTable&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(QTable& other) noexcept {
+        std::swap(slots, other.slots);
+        std::swap(slot_count, other.slot_count);
+        std::swap(old_slots, other.old_slots);
+        std::swap(old_slot_count, other.old_slot_count);
+        std::swap(migrate_index, other.migrate_index);
+        std::swap(count, other.count);
+        std::swap(grow_threshold, other.grow_threshold);
+    }
+
+    // Number of states stored.
+    size_t size() const { return count; }
+
+    // Number of slots allocated in the current table.
+    size_t capacity() const { return slot_count; }
+
+    // True while an earlier, smaller table is still being migrated.
+    bool is_growing() const { return old_slots != nullptr; }
+
+    // Bytes used by the slot arrays.
+    size_t memory_bytes() const { return (slot_count + old_slot_count) * sizeof(Slot); }
+
+    // Removes every entry but keeps the current allocation.
+    void clear() {
+        old_slots.reset();
+        old_slot_count = 0;
+        migrate_index = 0;
+        if (slot_count) {
+            std::memset(static_cast<void*>(slots.get()), 0, slot_count * sizeof(Slot));
+        }
+        count = 0;
+    }
+
+    // Makes room for at least `state_count` states without further growth.
+    // Unlike insertion this rehashes synchronously, so call it up front (not inside a frame).
+    void reserve(size_t state_count) {
+        size_t needed = 8;
+        while (needed - needed / 8 < state_count) {
+            needed <<= 1;
+        }
+        if (needed > slot_count) {
+            begin_growth(needed);
+        }
+        if (old_slots) {
+            migrate(old_slot_count);
+        }
+    }
+
+    // Hints the CPU to start loading the first slot `key` will probe.
+    void prefetch(StateKey key) const {
+        if (slot_count) {
+            PONG_PREFETCH(&slots[home_slot(key, slot_count)]);
+        }
+    }
+
+    // Returns the row for `key`, or nullptr if the key is absent.
+    const Row* find(StateKey key) const {
+        const Slot* slot = probe(slots.get(), slot_count, key);
+        if (!slot && old_slots) {
+            slot = probe(old_slots.get(), old_slot_count, key);
+        }
+        return slot ? &slot->row : nullptr;
+    }
+
+    Row* find(StateKey key) {
+        return const_cast<Row*>(static_cast<const QTable&>(*this).find(key));
+    }
+
+    // Returns the row for `key`, inserting a value-initialized row if it is absent.
+    // A single probe sequence both searches for the key and finds its insertion point
+    // (plus a lookup in the old table while growing). Never does more than a bounded
+    // amount of migration work.
+    Row& find_or_insert(StateKey key, bool* inserted = nullptr) {
+        if (old_slots) {
+            migrate(MIGRATION_STEP);
+        }
+        if (count + 1 > grow_threshold) {
+            // Only grow if the key is really new
+            if (Row* existing = find(key)) {
+                if (inserted) *inserted = false;
+                return *existing;
+            }
+            begin_growth(slot_count ? slot_count * 2 : 16);
+        }
+
+        size_t mask = slot_count - 1;
+        size_t index = home_slot(key, slot_count);
+        for (std::uint16_t distance = 1; ; ++distance) {
+            Slot& slot = slots[index];
+            if (slot.distance < distance) {
+                // Key is absent from the current table, and this is where it belongs.
+                // While growing it may still be waiting in the old table: bring its row along.
+                Row row{};
+                const Slot* old_slot = old_slots ? probe(old_slots.get(), old_slot_count, key) : nullptr;
+                if (old_slot) {
+                    row = old_slot->row;
+                } else {
+                    count++;
+                }
+                if (inserted) *inserted = (old_slot == nullptr);
+                // Take this slot and shift any richer resident further along the run
+                Slot displaced = slot;
+                slot = Slot{key, distance, row};
+                if (displaced.distance != 0) {
+                    displaced.distance++;
+                    carry_forward(displaced, (index + 1) & mask);
+                }
+                return slot.row;
+            }
+            if (slot.key == key) {
+                if (inserted) *inserted = false;
+                return slot.row;
+            }
+            index = (index + 1) & mask;
+        }
+    }
+
+    // Inserts or overwrites the row for `key`.
+    void insert_or_assign(StateKey key, const Row& row) {
+        find_or_insert(key) = row;
+    }
+
+    // Calls fn(StateKey, const Row&) for every entry.
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t i = 0; i < slot_count; ++i) {
+            if (slots[i].distance != 0) {
+                fn(slots[i].key, slots[i].row);
+            }
+        }
+        // Unmigrated entries of the old table that have not been pulled forward yet
+        for (size_t i = migrate_index; i < old_slot_count; ++i) {
+            const Slot& slot = old_slots[i];
+            if (slot.distance != 0 && !probe(slots.get(), slot_count, slot.key)) {
+                fn(slot.key, slot.row);
+            }
+        }
+    }
+
+    // Probe statistics (for the analysis tools): mean and longest probe distance of keys
+    // in the current table.
+    double average_probe_length() const {
+        size_t total = 0;
+        size_t stored = 0;
+        for (size_t i = 0; i < slot_count; ++i) {
+            total += slots[i].distance;
+            stored += (slots[i].distance != 0);
+        }
+        return stored ? static_cast<double>(total) / stored : 0.0;
+    }
+
+    size_t max_probe_length() const {
+        size_t longest = 0;
+        for (size_t i = 0; i < slot_count; ++i) {
+            if (slots[i].distance > longest) longest = slots[i].distance;
+        }
+        return longest;
+    }
+};
+
+#endif // PONG_QTABLE_H
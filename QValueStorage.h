@@ -0,0 +1,157 @@
+#ifndef PONG_QVALUESTORAGE_H
+#define PONG_QVALUESTORAGE_H
+
+#include <cmath>   // For std::floor
+#include <cstdint> // For uint16_t, int16_t, uint32_t
+#include <cstring> // For std::memcpy
+
+// --- Q-value storage formats ---
+// Q-values are always computed in double precision; these types only control how they are
+// stored in the Q-table. The 16-bit formats round stochastically when storing (the `dither`
+// argument, uniform in [0, 1)), so small learning-rate updates still move values on average
+// instead of being rounded away. A dither of 0.5 gives round-to-nearest.
+
+// IEEE 754 half precision (1 sign, 5 exponent, 10 mantissa bits).
+struct Half {
+    std::uint16_t bits;
+};
+
+// bfloat16: the upper 16 bits of a float (same range as float, 8 mantissa bits).
+struct BFloat16 {
+    std::uint16_t bits;
+};
+
+// Signed 16-bit fixed point: value = raw * scale, with the scale chosen per table.
+struct Fixed16 {
+    std::int16_t raw;
+};
+
+inline std::uint32_t float_bits(float f) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+inline float bits_float(std::uint32_t bits) {
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Half -> float (exact).
+inline float half_to_float(std::uint16_t h) {
+    std::uint32_t sign = static_cast<std::uint32_t>(h & 0x8000u) << 16;
+    std::uint32_t exponent = (h >> 10) & 0x1fu;
+    std::uint32_t mantissa = h & 0x3ffu;
+    if (exponent == 0) {
+        // Zero or subnormal: mantissa * 2^-24
+        float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+        return (sign ? -magnitude : magnitude);
+    }
+    if (exponent == 31) {
+        return bits_float(sign | 0x7f800000u | (mantissa << 13)); // Inf / NaN
+    }
+    return bits_float(sign | ((exponent - 15 + 127) << 23) | (mantissa << 13));
+}
+
+// Float -> half, rounding toward zero and saturating at the largest finite half.
+inline std::uint16_t float_to_half_truncate(float f) {
+    std::uint32_t x = float_bits(f);
+    std::uint16_t sign = static_cast<std::uint16_t>((x >> 16) & 0x8000u);
+    std::uint32_t magnitude = x & 0x7fffffffu;
+    if (magnitude > 0x7f800000u) return static_cast<std::uint16_t>(sign | 0x7e00u); // NaN
+    int exponent = static_cast<int>(magnitude >> 23) - 127 + 15;
+    std::uint32_t mantissa = magnitude & 0x7fffffu;
+    if (exponent >= 31) return static_cast<std::uint16_t>(sign | 0x7bffu); // Saturate
+    if (exponent <= 0) {
+        if (exponent < -10) return sign; // Underflows to zero
+        mantissa |= 0x800000u; // Subnormal: shift in the implicit leading bit
+        return static_cast<std::uint16_t>(sign | (mantissa >> (14 - exponent)));
+    }
+    return static_cast<std::uint16_t>(sign | (exponent << 10) | (mantissa >> 13));
+}
+
+// Codec for one storage type: decode to double, encode from double.
+// `scale` is only used by Fixed16. `stochastic` says whether encode consumes its dither.
+// `save_digits` is how many significant digits a saved value needs to load back as the same
+// stored value (for double and float: to load back as what it saved, which is stable too).
+template <typename T>
+struct QValueCodec;
+
+template <>
+struct QValueCodec<double> {
+    static const bool stochastic = false;
+    static const int save_digits = 6;
+    static double decode(double v, double) { return v; }
+    static double encode(double v, double, double) { return v; }
+};
+
+template <>
+struct QValueCodec<float> {
+    static const bool stochastic = false;
+    static const int save_digits = 6;
+    static double decode(float v, double) { return v; }
+    static float encode(double v, double, double) { return static_cast<float>(v); }
+};
+
+template <>
+struct QValueCodec<Half> {
+    static const bool stochastic = true;
+    static const int save_digits = 5; // 11-bit significand
+    static double decode(Half v, double) { return half_to_float(v.bits); }
+    static Half encode(double v, double, double dither) {
+        // Round the magnitude down, then up by one unit with probability equal to the remainder
+        float f = static_cast<float>(v);
+        std::uint16_t low = float_to_half_truncate(f);
+        if ((low & 0x7fffu) >= 0x7bffu) return Half{low}; // Saturated (or NaN)
+        std::uint16_t high = static_cast<std::uint16_t>(low + 1);
+        float low_magnitude = std::fabs(half_to_float(low));
+        float high_magnitude = std::fabs(half_to_float(high));
+        double fraction = (std::fabs(f) - low_magnitude) / (high_magnitude - low_magnitude);
+        return Half{dither < fraction ? high : low};
+    }
+};
+
+template <>
+struct QValueCodec<BFloat16> {
+    static const bool stochastic = true;
+    static const int save_digits = 4; // 8-bit significand
+    static double decode(BFloat16 v, double) { return bits_float(static_cast<std::uint32_t>(v.bits) << 16); }
+    static BFloat16 encode(double v, double, double dither) {
+        // The dropped low 16 bits are the remainder: add a random 16-bit amount and truncate
+        std::uint32_t x = float_bits(static_cast<float>(v));
+        if ((x & 0x7f800000u) == 0x7f800000u) return BFloat16{static_cast<std::uint16_t>(x >> 16)}; // Inf / NaN
+        std::uint32_t rounded = x + static_cast<std::uint32_t>(dither * 65536.0);
+        if ((rounded & 0x7f800000u) == 0x7f800000u) rounded = x; // Don't round up into infinity
+        return BFloat16{static_cast<std::uint16_t>(rounded >> 16)};
+    }
+};
+
+template <>
+struct QValueCodec<Fixed16> {
+    static const bool stochastic = true;
+    static const int save_digits = 6;
+    static double decode(Fixed16 v, double scale) { return v.raw * scale; }
+    static Fixed16 encode(double v, double scale, double dither) {
+        double x = v / scale;
+        double low = std::floor(x);
+        double raw = low + ((dither < x - low) ? 1.0 : 0.0);
+        if (raw > 32767.0) raw = 32767.0;
+        if (raw < -32767.0) raw = -32767.0;
+        return Fixed16{static_cast<std::int16_t>(raw)};
+    }
+};
+
+// --- Build-time selection ---
+// The Q-table storage type is chosen with the PONG_Q_STORAGE definition
+// (double, float, Half, BFloat16 or Fixed16); see CMakeLists.txt.
+#ifndef PONG_Q_STORAGE
+#define PONG_Q_STORAGE double
+#endif
+typedef PONG_Q_STORAGE QValueStorage;
+
+// Largest |Q| the Fixed16 format is scaled for by default. Rewards are at most 20 in magnitude
+// and gamma at most 0.95, so |Q| stays below 20 / (1 - 0.95) = 400.
+const double DEFAULT_Q_VALUE_BOUND = 1000.0;
+
+#endif // PONG_QVALUESTORAGE_H
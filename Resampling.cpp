@@ -0,0 +1,186 @@
+#include "Resampling.h"
+#include "QTable.h"
+#include <algorithm> // For std::min
+#include <array>
+#include <cstdint>   // For uint16_t, uint32_t
+#include <iostream>  // For error messages
+
+// How the cells of one axis map from the source grid to the target grid: source cell i
+// covers target cells [first[i], first[i] + count[i]).
+struct AxisMap {
+    int first[STATE_MAX_DIVISIONS];
+    int count[STATE_MAX_DIVISIONS];
+};
+
+// Cell mapping for one axis going from `from` to `to` divisions.
+static AxisMap map_axis(int from, int to) {
+    AxisMap map;
+    if (to >= from) {
+        // Finer (or the same): target cell j belongs to the source cell holding its center,
+        // (j + 1/2) / to of the field, i.e. floor((2j + 1) * from / (2 * to)). A source cell is
+        // at least as wide as a target cell, so it always holds at least one center.
+        for (int i = 0; i < from; ++i) {
+            map.count[i] = 0;
+        }
+        for (int j = to - 1; j >= 0; --j) {
+            int parent = (2 * j + 1) * from / (2 * to);
+            map.first[parent] = j;
+            map.count[parent]++;
+        }
+    } else {
+        // Coarser: each source cell goes to the target cell holding its center
+        for (int i = 0; i < from; ++i) {
+            map.first[i] = (2 * i + 1) * to / (2 * from);
+            map.count[i] = 1;
+        }
+    }
+    return map;
+}
+
+// Number of target cells a source State covers.
+static int target_count(const State& s, const AxisMap& x, const AxisMap& y, const AxisMap& paddle) {
+    return x.count[s.ball_x_grid] * y.count[s.ball_y_grid] *
+           paddle.count[s.cpu_paddle_y_grid] * paddle.count[s.player_paddle_y_grid];
+}
+
+// Calls emit(target_key) for each target cell a source State covers.
+template <typename Emit>
+static void for_each_target(const State& s, const AxisMap& x, const AxisMap& y, const AxisMap& paddle, Emit emit) {
+    int x_first = x.first[s.ball_x_grid], x_count = x.count[s.ball_x_grid];
+    int y_first = y.first[s.ball_y_grid], y_count = y.count[s.ball_y_grid];
+    int cpu_first = paddle.first[s.cpu_paddle_y_grid], cpu_count = paddle.count[s.cpu_paddle_y_grid];
+    int player_first = paddle.first[s.player_paddle_y_grid], player_count = paddle.count[s.player_paddle_y_grid];
+
+    State t = s; // Velocity categories carry over unchanged
+    for (int xi = 0; xi < x_count; ++xi) {
+        t.ball_x_grid = x_first + xi;
+        for (int yi = 0; yi < y_count; ++yi) {
+            t.ball_y_grid = y_first + yi;
+            for (int ci = 0; ci < cpu_count; ++ci) {
+                t.cpu_paddle_y_grid = cpu_first + ci;
+                for (int pi = 0; pi < player_count; ++pi) {
+                    t.player_paddle_y_grid = player_first + pi;
+                    emit(encode_state(t));
+                }
+            }
+        }
+    }
+}
+
+// Share of a parent's `visits` that its child number `child` (of `fanout`) gets: an even split,
+// the remainder going one each to the first children, so the shares add up to `visits`.
+static std::uint16_t split_visits(std::uint16_t visits, int fanout, int child) {
+    return static_cast<std::uint16_t>(visits / fanout + (child < visits % fanout ? 1 : 0));
+}
+
+static std::uint16_t saturate_visits(double visits) {
+    return static_cast<std::uint16_t>(std::min(visits, static_cast<double>(MAX_VISIT_COUNT)));
+}
+
+// Running sums for one target state while merging source states into it.
+struct ResampleSums {
+    double weighted[NUM_ACTIONS]; // Sum of visits * Q
+    double weight[NUM_ACTIONS];   // Sum of visits
+    double plain[NUM_ACTIONS];    // Sum of Q (for actions never visited in any source)
+    double visits[NUM_ACTIONS];   // Sum of the visits carried over
+    std::uint32_t sources;        // Source states merged
+};
+
+bool resample_q_table(const QLearningAgent& source, const Discretization& from,
+                      const Discretization& to, QLearningAgent& target, ResamplingStats* stats) {
+    if (!from.is_valid() || !to.is_valid()) {
+        std::cerr << "Error: Grid sizes must be between 1 and " << STATE_MAX_DIVISIONS << "." << std::endl;
+        return false;
+    }
+    if (&source == &target) {
+        std::cerr << "Error: Cannot resample a Q-table into itself." << std::endl;
+        return false;
+    }
+
+    const AxisMap x = map_axis(from.grid_x, to.grid_x);
+    const AxisMap y = map_axis(from.grid_y, to.grid_y);
+    const AxisMap paddle = map_axis(from.paddle_y, to.paddle_y);
+    const bool coarsens = to.grid_x < from.grid_x || to.grid_y < from.grid_y || to.paddle_y < from.paddle_y;
+
+    // Every state the source knows (with mirror symmetry, both halves of each stored row)
+    ResamplingStats result;
+    size_t known_states = 0;
+    source.for_each_known_state([&known_states](StateKey, const QRow&) { known_states++; });
+    result.source_states = known_states;
+    target.clear_q_table();
+
+    if (!coarsens) {
+        // Every target cell has exactly one parent: copy its values straight in. Size the table
+        // for all of them first so the inserts never grow it.
+        size_t expected = 0;
+        source.for_each_known_state([&](StateKey key, const QRow&) {
+            State s = decode_state(key);
+            if (from.contains(s)) {
+                expected += static_cast<size_t>(target_count(s, x, y, paddle));
+            }
+        });
+        target.reserve(std::min(expected, to.state_space_size()));
+
+        source.for_each_known_state([&](StateKey key, const QRow& row) {
+            State s = decode_state(key);
+            if (!from.contains(s)) {
+                result.skipped_states++;
+                return;
+            }
+            QValues q = source.get_q_values(row);
+            int fanout = target_count(s, x, y, paddle);
+            int child = 0;
+            for_each_target(s, x, y, paddle, [&](StateKey target_key) {
+                std::array<std::uint16_t, NUM_ACTIONS> visits;
+                for (int a = 0; a < NUM_ACTIONS; ++a) {
+                    visits[a] = split_visits(row.visits[a], fanout, child);
+                }
+                target.set_q_values(target_key, q, visits);
+                child++;
+            });
+        });
+    } else {
+        // Gather visit-weighted sums per target state, then write the averages. The scratch table
+        // is sized for the source's share of the state space, carried over to the target grid.
+        QTable<ResampleSums> sums;
+        double occupancy = static_cast<double>(known_states) / static_cast<double>(from.state_space_size());
+        sums.reserve(std::min(static_cast<size_t>(occupancy * to.state_space_size()) + 1, to.state_space_size()));
+        source.for_each_known_state([&](StateKey key, const QRow& row) {
+            State s = decode_state(key);
+            if (!from.contains(s)) {
+                result.skipped_states++;
+                return;
+            }
+            QValues q = source.get_q_values(row);
+            int fanout = target_count(s, x, y, paddle);
+            int child = 0;
+            for_each_target(s, x, y, paddle, [&](StateKey target_key) {
+                ResampleSums& sum = sums.find_or_insert(target_key);
+                for (int a = 0; a < NUM_ACTIONS; ++a) {
+                    double w = row.visits[a];
+                    sum.weighted[a] += w * q[a];
+                    sum.weight[a] += w;
+                    sum.plain[a] += q[a];
+                    sum.visits[a] += split_visits(row.visits[a], fanout, child);
+                }
+                sum.sources++;
+                child++;
+            });
+        });
+
+        target.reserve(sums.size());
+        sums.for_each([&target](StateKey key, const ResampleSums& sum) {
+            QValues q;
+            std::array<std::uint16_t, NUM_ACTIONS> visits;
+            for (int a = 0; a < NUM_ACTIONS; ++a) {
+                q[a] = sum.weight[a] > 0.0 ? sum.weighted[a] / sum.weight[a] : sum.plain[a] / sum.sources;
+                visits[a] = saturate_visits(sum.visits[a]);
+            }
+            target.set_q_values(key, q, visits);
+        });
+    }
+
+    result.target_states = target.get_explored_state_count();
+    if (stats) *stats = result;
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef PONG_RESAMPLING_H
+#define PONG_RESAMPLING_H
+
+#include "State.h"
+#include "QLearningAgent.h"
+#include <cstddef> // For size_t
+
+// --- Q-table Resampling ---
+// Carries a Q-table learned on one grid over to another, so that a new resolution starts from
+// what the old one learned instead of from zero. Each axis is mapped on its own, by the
+// centers of the cells:
+//   - an axis that gets finer copies the value of the parent cell (the source cell containing
+//     the new cell's center) into every new cell;
+//   - an axis that gets coarser averages the source cells whose centers fall into the new cell,
+//     weighting each action's value by its visit count (a plain mean if none were visited).
+// Velocity categories are the same on every grid. Visit counts are carried over with the
+// values: split evenly between the children of a refined cell, summed over the cells merged
+// into a coarser one (saturating at MAX_VISIT_COUNT), so the total experience is conserved and
+// refining then coarsening back gives the original table.
+//
+// One pass over the states the source knows (both halves of a mirror-symmetric table). When no
+// axis gets coarser every new cell has exactly one parent and is written straight into the
+// target table; otherwise the sums are gathered in a scratch table keyed by the new state first.
+
+struct ResamplingStats {
+    size_t source_states = 0;  // States read from the source table
+    size_t skipped_states = 0; // Source states outside the `from` grid (ignored)
+    size_t target_states = 0;  // States written to the target table
+};
+
+// Replaces `target`'s Q-table with `source`'s (learned on grid `from`) resampled to grid `to`.
+// `target` keeps its own learning parameters and storage scale; it may not be `source`.
+// Returns false (and leaves `target` untouched) if a grid does not fit the packed key.
+bool resample_q_table(const QLearningAgent& source, const Discretization& from,
+                      const Discretization& to, QLearningAgent& target,
+                      ResamplingStats* stats = nullptr);
+
+#endif // PONG_RESAMPLING_H
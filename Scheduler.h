@@ -0,0 +1,97 @@
+#ifndef PONG_SCHEDULER_H
+#define PONG_SCHEDULER_H
+
+#include "QLearningAgent.h" // For DifficultyLevel
+
+// Rates of the game loop's three clocks. Physics runs on a fixed step whatever the frame rate;
+// the AI decides once every `action_repeat` physics steps and holds its action in between; and
+// the transitions it collects are learned from in batches of `learning_batch` decisions.
+struct ScheduleRates {
+    double physics_hz = 240.0; // Fixed physics steps per second
+    int action_repeat = 12;    // Physics steps per AI decision (12 at 240 Hz = 20 decisions/s)
+    int learning_batch = 1;    // AI decisions per learning pass
+
+    double decision_hz() const { return physics_hz / action_repeat; }
+};
+
+// Per-difficulty rates: the harder levels react sooner (more decisions per second) and learn
+// from their experience more often. Physics is the same for every level.
+inline ScheduleRates schedule_for_difficulty(DifficultyLevel level) {
+    ScheduleRates rates;
+    switch (level) {
+        case DifficultyLevel::EASY:
+            rates.action_repeat = 24; // 10 decisions/s (100 ms reaction time)
+            rates.learning_batch = 4;
+            break;
+        case DifficultyLevel::MEDIUM:
+            rates.action_repeat = 12; // 20 decisions/s
+            rates.learning_batch = 2;
+            break;
+        case DifficultyLevel::HARD:
+            rates.action_repeat = 4;  // 60 decisions/s
+            rates.learning_batch = 1;
+            break;
+    }
+    return rates;
+}
+
+// Turns variable frame times into fixed physics steps and marks which of those steps start a
+// new AI decision. Per frame:
+//
+//   int steps = scheduler.advance(frame_seconds);
+//   for (int i = 0; i < steps; ++i) {
+//       if (scheduler.decision_due()) { ...choose an action...; scheduler.start_decision(); }
+//       ...one physics step of scheduler.step_seconds()...
+//       scheduler.finish_step();
+//       if (scheduler.decision_due()) { ...the decision's transition is complete... }
+//   }
+class FixedStepScheduler {
+private:
+    // Frame time beyond this is dropped rather than simulated (e.g. after the window was
+    // dragged), so a stall never turns into a burst of catch-up steps.
+    static constexpr double MAX_FRAME_SECONDS = 0.25;
+
+    ScheduleRates rates;
+    double pending_seconds;  // Real time not yet simulated (less than one step between frames)
+    int steps_until_decision; // Physics steps left in the current decision (0 = decide now)
+
+public:
+    explicit FixedStepScheduler(const ScheduleRates& rates = ScheduleRates())
+        : rates(rates), pending_seconds(0.0), steps_until_decision(0) {}
+
+    // Changes the rates. The current decision runs to its end at the old action repeat.
+    void set_rates(const ScheduleRates& new_rates) { rates = new_rates; }
+    const ScheduleRates& get_rates() const { return rates; }
+
+    // Length of one physics step in seconds.
+    float step_seconds() const { return static_cast<float>(1.0 / rates.physics_hz); }
+
+    // Adds a frame's elapsed time and returns how many physics steps to run for it.
+    int advance(double frame_seconds) {
+        pending_seconds += (frame_seconds < MAX_FRAME_SECONDS) ? frame_seconds : MAX_FRAME_SECONDS;
+        int steps = static_cast<int>(pending_seconds * rates.physics_hz);
+        pending_seconds -= steps / rates.physics_hz;
+        return steps;
+    }
+
+    // True when the AI should choose a new action (before the next step), which is also when
+    // the previous decision's transition is complete (after the last step).
+    bool decision_due() const { return steps_until_decision <= 0; }
+
+    // A new action was chosen: hold it for `action_repeat` steps.
+    void start_decision() { steps_until_decision = rates.action_repeat; }
+
+    // One physics step was simulated.
+    void finish_step() { steps_until_decision--; }
+
+    // Ends the current decision early (e.g. when a point ends mid-decision).
+    void end_decision() { steps_until_decision = 0; }
+
+    // Forgets leftover time and any decision in progress (e.g. when a new game starts).
+    void reset() {
+        pending_seconds = 0.0;
+        steps_until_decision = 0;
+    }
+};
+
+#endif // PONG_SCHEDULER_H
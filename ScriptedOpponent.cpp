@@ -0,0 +1,30 @@
+#include "ScriptedOpponent.h"
+#include "GameConstants.h"
+
+// Constructor
+ScriptedOpponent::ScriptedOpponent(float skill, unsigned int seed)
+    : skill(skill), deadZone(PADDLE_HEIGHT / 8.0f),
+      rng(seed), chance(0.0f, 1.0f)
+{
+}
+
+// Track the ball when it approaches, otherwise return to the center
+Action ScriptedOpponent::chooseAction(const Simulation& world, bool leftSide) {
+    if (chance(rng) >= skill) {
+        return Action::STAY; // Too slow to react this step
+    }
+
+    const Paddle& paddle = leftSide ? world.getLeftPaddle() : world.getRightPaddle();
+    const Ball& ball = world.getBall();
+    float paddleCenterY = paddle.getPosition().y + PADDLE_HEIGHT / 2.0f;
+    bool approaching = leftSide ? (ball.getVelocity().x < 0) : (ball.getVelocity().x > 0);
+    float targetY = approaching ? ball.getPosition().y : world.getFieldSize().y / 2.0f;
+
+    Action action = Action::STAY;
+    if (targetY < paddleCenterY - deadZone) {
+        action = Action::UP;
+    } else if (targetY > paddleCenterY + deadZone) {
+        action = Action::DOWN;
+    }
+    return action;
+}
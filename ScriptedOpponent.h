@@ -0,0 +1,28 @@
+#ifndef PONG_SCRIPTEDOPPONENT_H
+#define PONG_SCRIPTEDOPPONENT_H
+
+#include "Simulation.h"
+#include "QLearningAgent.h" // For Action
+#include <random>
+
+// A hand-written paddle controller, used as a fixed benchmark opponent for headless training
+// and evaluation. It follows the ball's height while the ball comes toward it and drifts back
+// to the center otherwise. `skill` is the fraction of steps in which it moves at all, so it
+// caps the paddle's effective speed: at low skill fast balls get past it.
+class ScriptedOpponent {
+private:
+    float skill;    // Chance of moving in a given step (1 = perfect tracker)
+    float deadZone; // Don't move when the target is closer than this (pixels)
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> chance;
+
+public:
+    explicit ScriptedOpponent(float skill = 0.5f, unsigned int seed = 1);
+
+    // Chooses the action for the left (or right) paddle of `world`.
+    Action chooseAction(const Simulation& world, bool leftSide);
+
+    float getSkill() const { return skill; }
+};
+
+#endif // PONG_SCRIPTEDOPPONENT_H
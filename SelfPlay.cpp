@@ -0,0 +1,87 @@
+#include "SelfPlay.h"
+
+// Constructor
+SelfPlayTrainer::SelfPlayTrainer(const SelfPlayConfig& config)
+    : config(config),
+      world(config.seed),
+      right_agent(config.seed + 1),
+      left_agent(config.seed + 2),
+      rng(config.seed + 3),
+      opponent(-1),
+      total_steps(0)
+{
+    right_agent.set_parameters(config.alpha, config.gamma, config.epsilon);
+    left_agent.set_parameters(config.alpha, config.gamma, config.epsilon);
+}
+
+// Freeze the current greedy policy as a future opponent
+void SelfPlayTrainer::take_snapshot() {
+    if (config.max_snapshots == 0) return;
+    if (snapshots.size() >= config.max_snapshots) {
+        snapshots.erase(snapshots.begin()); // Drop the oldest
+    }
+    snapshots.push_back(GreedyPolicy::compile(right_agent));
+}
+
+// Live agent or a random snapshot for the next point
+void SelfPlayTrainer::choose_opponent() {
+    opponent = -1;
+    if (snapshots.empty()) return;
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    if (chance(rng) < config.snapshot_probability) {
+        std::uniform_int_distribution<int> pick(0, static_cast<int>(snapshots.size()) - 1);
+        opponent = pick(rng);
+    }
+}
+
+// Simulate and learn
+SelfPlayStats SelfPlayTrainer::run(long steps) {
+    SelfPlayStats stats;
+    for (long i = 0; i < steps; ++i) {
+        // 1. Both sides observe the field from their own (mirrored) point of view and act
+        State right_state = world.getRightState();
+        State left_state = world.getLeftState();
+        Action right_action = right_agent.choose_action(right_state);
+        Action left_action = (opponent >= 0) ? snapshots[opponent].choose_action(left_state)
+                                             : left_learner().choose_action(left_state);
+
+        // 2. Advance the physics
+        StepEvents events = world.step(config.dt, left_action, right_action);
+        bool scored = (events.scoreEvent != 0);
+
+        // 3. Learn from the transition, with the same rewards the game gives the CPU paddle
+        State right_next = world.getRightState();
+        State left_next = world.getLeftState();
+        double right_reward = compute_step_reward(events, true, right_action, right_next);
+        double left_reward = compute_step_reward(events, false, left_action, left_next);
+        if (config.semi_mdp) {
+            right_transition.observe(right_agent, right_state, right_action, right_reward, right_next, config.dt);
+            if (scored) right_transition.flush(right_agent);
+            if (opponent < 0) {
+                left_transition.observe(left_learner(), left_state, left_action, left_reward, left_next, config.dt);
+                if (scored) left_transition.flush(left_learner());
+            }
+        } else {
+            right_agent.update_q_value(right_state, right_action, right_reward, right_next);
+            if (opponent < 0) {
+                left_learner().update_q_value(left_state, left_action, left_reward, left_next);
+            }
+        }
+
+        // 4. Bookkeeping
+        stats.steps++;
+        stats.right_hits += events.rightHit;
+        stats.left_hits += events.leftHit;
+        if (scored) {
+            stats.points++;
+            stats.right_conceded += (events.scoreEvent == 1); // Left paddle scored
+            stats.snapshot_points += (opponent >= 0);
+            choose_opponent(); // New point, possibly a new opponent
+        }
+        total_steps++;
+        if (config.snapshot_interval > 0 && total_steps % config.snapshot_interval == 0) {
+            take_snapshot();
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,82 @@
+#ifndef PONG_SELFPLAY_H
+#define PONG_SELFPLAY_H
+
+#include "Simulation.h"
+#include "QLearningAgent.h"
+#include "GreedyPolicy.h"
+#include "SemiMdp.h"
+#include <cstddef> // For size_t
+#include <random>
+#include <vector>
+
+// Settings for a headless self-play run.
+struct SelfPlayConfig {
+    long steps = 5000000;           // Physics steps to simulate
+    float dt = 1.0f / 60.0f;        // Seconds per step (the game's frame time at 60 FPS)
+    bool share_table = true;        // Both paddles learn into one Q-table (their states are mirrored)
+    long snapshot_interval = 200000; // Steps between opponent snapshots (0 = never snapshot)
+    size_t max_snapshots = 8;       // Oldest snapshots are dropped beyond this
+    double snapshot_probability = 0.5; // Chance that a point is played against a snapshot
+    double alpha = 0.1;
+    double gamma = 0.9;
+    double epsilon = 0.1;
+    bool semi_mdp = false;          // Update once per change of discretized state (see SemiMdp.h)
+    unsigned int seed = 1;          // Seeds the agents, the ball and the opponent choice
+};
+
+// Counters for a self-play run (or part of one).
+struct SelfPlayStats {
+    long steps = 0;
+    long points = 0;          // Points played
+    long snapshot_points = 0; // Points where the left paddle was a frozen snapshot
+    long right_hits = 0;      // Returns by the right (learning) paddle
+    long left_hits = 0;       // Returns by the left paddle
+    long right_conceded = 0;  // Points lost by the right paddle
+};
+
+// Trains Q-learning agents by letting them play each other with no window and no frame limit.
+//
+// The right paddle is always a learning agent. The left paddle sees the field through
+// Simulation::getLeftState, which mirrors it to look like the right paddle's view, so both
+// sides can learn into the same Q-table (`share_table`) or into separate ones. Every
+// `snapshot_interval` steps the right agent's greedy policy is frozen into a snapshot; at the
+// start of each point the left paddle is, with `snapshot_probability`, replaced by a randomly
+// chosen snapshot, so the agent keeps facing older versions of itself instead of only
+// co-adapting to its current self. Snapshots do not learn.
+class SelfPlayTrainer {
+private:
+    SelfPlayConfig config;
+    Simulation world;
+    QLearningAgent right_agent;
+    QLearningAgent left_agent; // Unused when the table is shared
+    std::vector<GreedyPolicy> snapshots;
+    SemiMdpAccumulator right_transition; // Semi-MDP mode: one accumulator per paddle,
+    SemiMdpAccumulator left_transition;  // even when both learn into the same table
+    std::mt19937 rng; // Opponent choice
+    int opponent;     // Snapshot playing the left paddle this point, or -1 for the live agent
+    long total_steps; // Steps simulated so far (drives the snapshot schedule)
+
+    // The agent learning on the left side (the right agent itself when sharing a table).
+    QLearningAgent& left_learner() { return config.share_table ? right_agent : left_agent; }
+
+    // Picks the left paddle's opponent for the next point.
+    void choose_opponent();
+
+public:
+    explicit SelfPlayTrainer(const SelfPlayConfig& config);
+
+    // Freezes the right agent's current greedy policy into the snapshot pool.
+    void take_snapshot();
+
+    // Simulates `steps` steps (learning as it goes) and returns what happened in them.
+    SelfPlayStats run(long steps);
+
+    // The right paddle's agent: its Q-table is directly usable by the game's CPU paddle.
+    QLearningAgent& get_agent() { return right_agent; }
+    // The left paddle's learning agent (the same object as get_agent() when sharing a table).
+    QLearningAgent& get_left_agent() { return left_learner(); }
+
+    size_t get_snapshot_count() const { return snapshots.size(); }
+};
+
+#endif // PONG_SELFPLAY_H
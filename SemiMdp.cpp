@@ -0,0 +1,51 @@
+#include "SemiMdp.h"
+#include <cmath> // For std::pow
+
+// Constructor
+SemiMdpAccumulator::SemiMdpAccumulator()
+    : active(false), action(Action::STAY), reward(0.0), elapsed(0.0)
+{
+}
+
+// One update for the whole stay in `start`
+void SemiMdpAccumulator::apply(QLearningAgent& agent, const State& next_state) {
+    double discount = std::pow(agent.get_gamma(), elapsed / DISCOUNT_TIME_STEP);
+    agent.update_q_value(start, action, reward, next_state, discount);
+    active = false;
+}
+
+// Accumulate a tick, update on a state change
+void SemiMdpAccumulator::observe(QLearningAgent& agent, const State& state, Action new_action, double tick_reward,
+                                 const State& next_state, double seconds) {
+    // A state we never saw the transition into ends the old transition there. A different action
+    // in the same state drops it: it never left `start`, so there is no next state to bootstrap
+    // from but `start` itself, and that self-transition is the backup semi-MDP updates avoid.
+    if (active && !(state == start)) {
+        apply(agent, state);
+    } else if (active && new_action != action) {
+        active = false;
+    }
+    if (!active) {
+        active = true;
+        start = state;
+        action = new_action;
+        reward = 0.0;
+        elapsed = 0.0;
+    }
+
+    // The tick's reward is discounted by the time already spent in the state
+    reward += std::pow(agent.get_gamma(), elapsed / DISCOUNT_TIME_STEP) * tick_reward;
+    elapsed += seconds;
+    last_next = next_state;
+
+    if (!(next_state == start)) {
+        apply(agent, next_state);
+    }
+}
+
+// Apply the pending transition immediately
+void SemiMdpAccumulator::flush(QLearningAgent& agent) {
+    if (active) {
+        apply(agent, last_next);
+    }
+}
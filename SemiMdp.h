@@ -0,0 +1,51 @@
+#ifndef PONG_SEMIMDP_H
+#define PONG_SEMIMDP_H
+
+#include "State.h"
+#include "QLearningAgent.h"
+
+// Simulated time one discount step of gamma stands for: gamma is the discount per 1/60 s
+// (one frame at the game's usual frame rate), whatever the actual tick rate.
+const double DISCOUNT_TIME_STEP = 1.0 / 60.0;
+
+// Semi-MDP learning for one paddle. The ball usually stays in the same grid cell for many
+// ticks, and updating Q(s, a) toward r + gamma * max Q(s, .) on every one of those ticks mostly
+// repeats self-transitions, which costs updates and biases the values toward the state itself.
+// Instead, ticks are accumulated while the discretized State (and the action) stay the same:
+//   R = sum of r_k * gamma^(t_k / DISCOUNT_TIME_STEP), t_k = time since the State was entered,
+// and a single update is applied when the State changes, discounting the next State's value by
+// gamma^(elapsed / DISCOUNT_TIME_STEP). Values then depend on elapsed time, not on the tick rate.
+//
+// Keep one accumulator per paddle (two paddles can share an agent, but not an accumulator).
+class SemiMdpAccumulator {
+private:
+    bool active;      // A transition is in progress
+    State start;      // State the transition started in
+    Action action;    // Action held since then
+    double reward;    // Discounted reward accumulated so far
+    double elapsed;   // Seconds since `start` was entered
+    State last_next;  // Latest next state observed (used by flush)
+
+    // Applies the pending transition as one update toward `next_state`.
+    void apply(QLearningAgent& agent, const State& next_state);
+
+public:
+    SemiMdpAccumulator();
+
+    // Records one tick: `action` was taken in `state`, earned `reward` and led to `next_state`
+    // after `seconds`. Updates the agent only when the discretized state changes. A change of
+    // action within a state drops the transition so far (it would only bootstrap from its own
+    // state) and starts a new one for the new action.
+    void observe(QLearningAgent& agent, const State& state, Action action, double reward,
+                 const State& next_state, double seconds);
+
+    // Applies any pending transition now (e.g. after a score ends the point).
+    void flush(QLearningAgent& agent);
+
+    // Drops any pending transition without learning from it (e.g. when a new game starts).
+    void discard() { active = false; }
+
+    bool has_pending() const { return active; }
+};
+
+#endif // PONG_SEMIMDP_H
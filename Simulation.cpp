@@ -0,0 +1,166 @@
+#include "Simulation.h"
+#include "GameConstants.h"
+
+// Shared reward function
+double compute_reward(bool conceded, bool hitBall, bool movedUnnecessarily) {
+    double reward = 0.0;
+
+    // Reward for hitting the ball (positive reinforcement)
+    if (hitBall) {
+        reward += 10.0;
+    }
+
+    // Penalty for conceding a goal (negative reinforcement)
+    if (conceded) {
+        reward -= 20.0; // Significant penalty
+    }
+    // Note: No direct reward for scoring, as hitting the ball leads to that.
+
+    // Penalty for unnecessary movement
+    if (movedUnnecessarily) {
+        reward -= 5.0; // Penalty specified
+    }
+
+    return reward;
+}
+
+// Reward for one side's action in a step
+double compute_step_reward(const StepEvents& events, bool rightSide, Action action, const State& nextState) {
+    bool scored = (events.scoreEvent != 0);
+    bool conceded = rightSide ? (events.scoreEvent == 1) : (events.scoreEvent == -1);
+    bool hitBall = rightSide ? events.rightHit : events.leftHit;
+    // States are seen from the paddle's own side, so -1 always means "moving away"
+    bool movedUnnecessarily = !scored && action != Action::STAY && nextState.ball_vx_category < 0;
+    return compute_reward(conceded, hitBall, movedUnnecessarily);
+}
+
+// Same reward from an Observation (the ball's x direction is what decides "unnecessary")
+double compute_step_reward(const StepEvents& events, bool rightSide, Action action, const Observation& nextObservation) {
+    bool scored = (events.scoreEvent != 0);
+    bool conceded = rightSide ? (events.scoreEvent == 1) : (events.scoreEvent == -1);
+    bool hitBall = rightSide ? events.rightHit : events.leftHit;
+    bool movedUnnecessarily = !scored && action != Action::STAY && nextObservation.ball_vx < 0.0f;
+    return compute_reward(conceded, hitBall, movedUnnecessarily);
+}
+
+// Constructor
+Simulation::Simulation(unsigned int seed)
+    : fieldSize(WINDOW_WIDTH, WINDOW_HEIGHT),
+      leftPaddle(PADDLE_MARGIN, WINDOW_HEIGHT / 2.0f - PADDLE_HEIGHT / 2.0f,
+                 PADDLE_WIDTH, PADDLE_HEIGHT, PADDLE_SPEED, fieldSize),
+      rightPaddle(WINDOW_WIDTH - PADDLE_WIDTH - PADDLE_MARGIN, WINDOW_HEIGHT / 2.0f - PADDLE_HEIGHT / 2.0f,
+                  PADDLE_WIDTH, PADDLE_HEIGHT, PADDLE_SPEED, fieldSize),
+      ball(WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f, BALL_RADIUS, BALL_INITIAL_SPEED, fieldSize, seed)
+{
+}
+
+// Reset paddles and ball
+void Simulation::reset() {
+    leftPaddle.setPosition(PADDLE_MARGIN, fieldSize.y / 2.0f - PADDLE_HEIGHT / 2.0f);
+    rightPaddle.setPosition(fieldSize.x - PADDLE_WIDTH - PADDLE_MARGIN, fieldSize.y / 2.0f - PADDLE_HEIGHT / 2.0f);
+    ball.reset();
+}
+
+// Move a paddle according to an action
+void Simulation::applyAction(Paddle& paddle, Action action, float dt) {
+    if (action == Action::UP) {
+        paddle.moveUp(dt);
+    } else if (action == Action::DOWN) {
+        paddle.moveDown(dt);
+    }
+    // Action::STAY - do nothing
+}
+
+// Advance the simulation by one step
+StepEvents Simulation::step(float dt, Action leftAction, Action rightAction) {
+    StepEvents events;
+
+    // --- Paddle Movement ---
+    applyAction(leftPaddle, leftAction, dt);
+    applyAction(rightPaddle, rightAction, dt);
+
+    // --- Ball Movement & Wall Collision ---
+    events.scoreEvent = ball.update(dt); // Ball resets itself after a score
+    if (events.scoreEvent != 0) {
+        return events; // The new ball is at the center, no paddle can touch it
+    }
+
+    // --- Paddle Collision ---
+    sf::FloatRect ballBounds = ball.getGlobalBounds();
+    sf::FloatRect leftBounds = leftPaddle.getGlobalBounds();
+    sf::FloatRect rightBounds = rightPaddle.getGlobalBounds();
+
+    // Collision with left paddle
+    if (ballBounds.intersects(leftBounds)) {
+        // Check if ball is moving towards the paddle (left) to prevent multi-hits
+        if (ball.getVelocity().x < 0) {
+            ball.bounceX();
+            ball.increaseSpeed();
+            // Correct ball position slightly to prevent sticking
+            ball.setPosition(leftBounds.left + leftBounds.width + ball.getRadius() + 1.0f, ball.getPosition().y);
+            events.leftHit = true;
+        }
+    }
+
+    // Collision with right paddle
+    if (ballBounds.intersects(rightBounds)) {
+        // Check if ball is moving towards the paddle (right)
+        if (ball.getVelocity().x > 0) {
+            ball.bounceX();
+            ball.increaseSpeed();
+            // Correct ball position slightly
+            ball.setPosition(rightBounds.left - ball.getRadius() - 1.0f, ball.getPosition().y);
+            events.rightHit = true;
+        }
+    }
+
+    return events;
+}
+
+// Right (CPU) paddle's view
+State Simulation::getRightState() const {
+    sf::Vector2f ballPos = ball.getPosition();
+    sf::Vector2f ballVel = ball.getVelocity();
+    float rightCenterY = rightPaddle.getPosition().y + PADDLE_HEIGHT / 2.0f;
+    float leftCenterY = leftPaddle.getPosition().y + PADDLE_HEIGHT / 2.0f;
+    if (discretization.is_default()) {
+        return DefaultDiscretizer::discretize(ballPos.x, ballPos.y, ballVel.x, ballVel.y, rightCenterY, leftCenterY);
+    }
+    return discretize_state(ballPos.x, ballPos.y, ballVel.x, ballVel.y,
+                            rightCenterY, leftCenterY,
+                            static_cast<float>(fieldSize.x), static_cast<float>(fieldSize.y), discretization);
+}
+
+// Left paddle's view, mirrored to look like the right paddle's
+State Simulation::getLeftState() const {
+    sf::Vector2f ballPos = ball.getPosition();
+    sf::Vector2f ballVel = ball.getVelocity();
+    float rightCenterY = rightPaddle.getPosition().y + PADDLE_HEIGHT / 2.0f;
+    float leftCenterY = leftPaddle.getPosition().y + PADDLE_HEIGHT / 2.0f;
+    if (discretization.is_default()) {
+        return DefaultDiscretizer::discretize(fieldSize.x - ballPos.x, ballPos.y, -ballVel.x, ballVel.y, leftCenterY, rightCenterY);
+    }
+    return discretize_state(fieldSize.x - ballPos.x, ballPos.y, -ballVel.x, ballVel.y,
+                            leftCenterY, rightCenterY,
+                            static_cast<float>(fieldSize.x), static_cast<float>(fieldSize.y), discretization);
+}
+
+// Right paddle's continuous view
+Observation Simulation::getRightObservation() const {
+    sf::Vector2f ballPos = ball.getPosition();
+    sf::Vector2f ballVel = ball.getVelocity();
+    float rightCenterY = rightPaddle.getPosition().y + PADDLE_HEIGHT / 2.0f;
+    float leftCenterY = leftPaddle.getPosition().y + PADDLE_HEIGHT / 2.0f;
+    return make_observation(ballPos.x, ballPos.y, ballVel.x, ballVel.y, rightCenterY, leftCenterY,
+                            static_cast<float>(fieldSize.x), static_cast<float>(fieldSize.y));
+}
+
+// Left paddle's continuous view, mirrored like getLeftState
+Observation Simulation::getLeftObservation() const {
+    sf::Vector2f ballPos = ball.getPosition();
+    sf::Vector2f ballVel = ball.getVelocity();
+    float rightCenterY = rightPaddle.getPosition().y + PADDLE_HEIGHT / 2.0f;
+    float leftCenterY = leftPaddle.getPosition().y + PADDLE_HEIGHT / 2.0f;
+    return make_observation(fieldSize.x - ballPos.x, ballPos.y, -ballVel.x, ballVel.y, leftCenterY, rightCenterY,
+                            static_cast<float>(fieldSize.x), static_cast<float>(fieldSize.y));
+}
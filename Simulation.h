@@ -0,0 +1,92 @@
+#ifndef PONG_SIMULATION_H
+#define PONG_SIMULATION_H
+
+#include <SFML/Graphics.hpp>
+#include "Paddle.h"
+#include "Ball.h"
+#include "State.h"
+#include "QLearningAgent.h" // For Action
+#include <random>
+
+// What happened during one physics step.
+struct StepEvents {
+    int scoreEvent = 0;    // Same convention as Ball::update: 1 = left (player) scored, -1 = right (CPU) scored
+    bool leftHit = false;  // The left paddle returned the ball
+    bool rightHit = false; // The right paddle returned the ball
+};
+
+// Reward for one paddle's last action, shared by the game and headless training.
+// `conceded`: the ball got past this paddle; `hitBall`: this paddle returned the ball;
+// `movedUnnecessarily`: it moved while the ball was travelling away from it.
+double compute_reward(bool conceded, bool hitBall, bool movedUnnecessarily);
+
+// Reward for the action one side took in a step, given what happened and the state it led to
+// (seen from that side). Moving counts as unnecessary when the ball now travels away from the
+// paddle, except on a score, where `nextState` already belongs to the new serve.
+double compute_step_reward(const StepEvents& events, bool rightSide, Action action, const State& nextState);
+
+// Same, for agents that observe the field as an Observation.
+double compute_step_reward(const StepEvents& events, bool rightSide, Action action, const Observation& nextObservation);
+
+// The Pong playing field without any window or input: two paddles and a ball, advanced one
+// fixed step at a time with an Action per paddle. Game drives it from the keyboard and the AI;
+// headless training drives both sides with agents at full speed.
+class Simulation {
+private:
+    sf::Vector2u fieldSize;
+    Paddle leftPaddle;  // Player side
+    Paddle rightPaddle; // CPU side
+    Ball ball;
+    Discretization discretization; // Grid used by getRightState/getLeftState
+
+    // Move a paddle according to an action
+    static void applyAction(Paddle& paddle, Action action, float dt);
+
+public:
+    // Constructor. `seed` fixes the ball's serve directions for reproducible runs.
+    explicit Simulation(unsigned int seed = std::random_device{}());
+
+    // Center both paddles and serve a new ball.
+    void reset();
+
+    // Advance by `dt` seconds: move the paddles, move the ball (walls and scoring), then resolve
+    // paddle collisions. After a score the ball has already been served again.
+    StepEvents step(float dt, Action leftAction, Action rightAction);
+
+    // Grid used to discretize states (defaults to the game's).
+    void setDiscretization(const Discretization& grid) { discretization = grid; }
+    const Discretization& getDiscretization() const { return discretization; }
+
+    // Discrete state from the right (CPU) paddle's point of view.
+    State getRightState() const;
+
+    // Discrete state from the left paddle's point of view, mirrored horizontally so that it
+    // looks exactly like the right paddle's view: the left paddle appears as the "CPU" paddle
+    // on the right, and the ball's x position and x velocity are flipped.
+    State getLeftState() const;
+
+    // Continuous observations from each paddle's point of view (mirrored the same way).
+    Observation getRightObservation() const;
+    Observation getLeftObservation() const;
+
+    // Both of the right paddle's views (what the game hands to whichever agent plays).
+    AgentView getRightView() const { return AgentView{getRightState(), getRightObservation()}; }
+
+    // Only the view an agent type reads, for code templated on the agent: Input is State or
+    // Observation (AgentTraits<A>::Input, see Agent.h).
+    template <typename Input> Input getRightInput() const;
+
+    // --- Accessors (rendering, input) ---
+    Paddle& getLeftPaddle() { return leftPaddle; }
+    Paddle& getRightPaddle() { return rightPaddle; }
+    Ball& getBall() { return ball; }
+    const Paddle& getLeftPaddle() const { return leftPaddle; }
+    const Paddle& getRightPaddle() const { return rightPaddle; }
+    const Ball& getBall() const { return ball; }
+    sf::Vector2u getFieldSize() const { return fieldSize; }
+};
+
+template <> inline State Simulation::getRightInput<State>() const { return getRightState(); }
+template <> inline Observation Simulation::getRightInput<Observation>() const { return getRightObservation(); }
+
+#endif // PONG_SIMULATION_H
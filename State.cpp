@@ -0,0 +1,76 @@
+#include "State.h"
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For std::sqrt, std::fabs, std::fmod
+
+// Map a coordinate onto one of `divisions` equal cells of [0, extent), clamping to the valid range.
+// Same arithmetic as Discretizer (a multiply by divisions / extent), so both give the same cells.
+static int discretize_axis(float value, float extent, int divisions) {
+    return discretize_scaled(value * (static_cast<float>(divisions) / extent), divisions);
+}
+
+// Convert continuous game quantities to a discrete State
+State discretize_state(float ball_x, float ball_y, float ball_vx, float ball_vy,
+                       float cpu_paddle_center_y, float player_paddle_center_y,
+                       float field_width, float field_height) {
+    return discretize_state(ball_x, ball_y, ball_vx, ball_vy, cpu_paddle_center_y, player_paddle_center_y,
+                            field_width, field_height, Discretization());
+}
+
+// Convert continuous game quantities to a discrete State on a runtime grid
+State discretize_state(float ball_x, float ball_y, float ball_vx, float ball_vy,
+                       float cpu_paddle_center_y, float player_paddle_center_y,
+                       float field_width, float field_height, const Discretization& grid) {
+    State s;
+
+    // Discretize ball position
+    s.ball_x_grid = discretize_axis(ball_x, field_width, grid.grid_x);
+    s.ball_y_grid = discretize_axis(ball_y, field_height, grid.grid_y);
+
+    // Discretize ball velocity
+    s.ball_vx_category = velocity_category(ball_vx);
+    s.ball_vy_category = velocity_category(ball_vy); // 1 for down, -1 for up
+
+    // Discretize paddle positions
+    s.cpu_paddle_y_grid = discretize_axis(cpu_paddle_center_y, field_height, grid.paddle_y);
+    s.player_paddle_y_grid = discretize_axis(player_paddle_center_y, field_height, grid.paddle_y);
+
+    return s;
+}
+
+// Normalize a coordinate to [0, 1] of the field
+static float normalize_axis(float value, float extent) {
+    return std::max(0.0f, std::min(1.0f, value / extent));
+}
+
+// Convert continuous game quantities to a normalized Observation
+Observation make_observation(float ball_x, float ball_y, float ball_vx, float ball_vy,
+                             float cpu_paddle_center_y, float player_paddle_center_y,
+                             float field_width, float field_height) {
+    Observation o;
+    o.ball_x = normalize_axis(ball_x, field_width);
+    o.ball_y = normalize_axis(ball_y, field_height);
+
+    // Direction only: the ball speeds up over a rally, but where it will arrive depends on its angle
+    float speed = std::sqrt(ball_vx * ball_vx + ball_vy * ball_vy);
+    if (speed > 0.0f) {
+        o.ball_vx = ball_vx / speed;
+        o.ball_vy = ball_vy / speed;
+    }
+
+    o.cpu_paddle_y = normalize_axis(cpu_paddle_center_y, field_height);
+    o.player_paddle_y = normalize_axis(player_paddle_center_y, field_height);
+
+    // Predicted intercept: follow the ball in a straight line to the CPU's edge (x = field_width),
+    // treating the far edge as a mirror too, then fold the height back into the field
+    o.ball_intercept_y = o.ball_y;
+    if (ball_vx != 0.0f) {
+        float distance_x = (ball_vx > 0.0f) ? (field_width - ball_x) : (ball_x + field_width);
+        float y = ball_y + distance_x * ball_vy / std::fabs(ball_vx);
+        float period = 2.0f * field_height;
+        y = std::fmod(y, period);
+        if (y < 0.0f) y += period;
+        if (y > field_height) y = period - y;
+        o.ball_intercept_y = normalize_axis(y, field_height);
+    }
+    return o;
+}
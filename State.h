@@ -1,8 +1,11 @@
 #ifndef PONG_STATE_H
 #define PONG_STATE_H
 
+#include <algorithm> // For std::min, std::max
 #include <cstddef> // For size_t
+#include <cstdint> // For uint32_t
 #include <functional> // For std::hash
+#include "GameConstants.h" // For the field size
 
 // --- Constants for Discretization ---
 // Adjust these values based on your game window size and desired granularity
@@ -10,6 +13,14 @@ const int GRID_X_DIVISIONS = 10; // How many horizontal sections for ball positi
 const int GRID_Y_DIVISIONS = 10; // How many vertical sections for ball position
 const int PADDLE_Y_DIVISIONS = 10; // How many vertical sections for paddle position
 
+// Number of velocity categories per axis (-1, 0, 1)
+const int VELOCITY_CATEGORIES = 3;
+
+// Number of distinct States the discretization above can produce (an upper bound on the Q-table size)
+const size_t STATE_SPACE_SIZE = static_cast<size_t>(GRID_X_DIVISIONS) * GRID_Y_DIVISIONS *
+                                VELOCITY_CATEGORIES * VELOCITY_CATEGORIES *
+                                PADDLE_Y_DIVISIONS * PADDLE_Y_DIVISIONS;
+
 // Represents a discrete state of the game for the Q-learning agent.
 struct State {
     // Discretized ball position (indices into the grid)
@@ -38,28 +49,275 @@ struct State {
     }
 };
 
+// --- Packed State Key ---
+// A State packed into 32 bits, used as the Q-table key (4 bytes instead of 24).
+// Layout, from the least significant bit:
+//   bits  0-6   ball_x_grid
+//   bits  7-13  ball_y_grid
+//   bits 14-20  cpu_paddle_y_grid
+//   bits 21-27  player_paddle_y_grid
+//   bits 28-29  ball_vx_category + 1
+//   bits 30-31  ball_vy_category + 1
+// Grid fields get 7 bits each, so up to 128 divisions per axis fit in a key.
+typedef std::uint32_t StateKey;
+
+const int STATE_GRID_BITS = 7;
+const int STATE_MAX_DIVISIONS = 1 << STATE_GRID_BITS;
+const StateKey STATE_GRID_MASK = (1u << STATE_GRID_BITS) - 1u;
+
+// Packs a State into its 32-bit key.
+inline StateKey encode_state(const State& s) {
+    return (static_cast<StateKey>(s.ball_x_grid)) |
+           (static_cast<StateKey>(s.ball_y_grid) << 7) |
+           (static_cast<StateKey>(s.cpu_paddle_y_grid) << 14) |
+           (static_cast<StateKey>(s.player_paddle_y_grid) << 21) |
+           (static_cast<StateKey>(s.ball_vx_category + 1) << 28) |
+           (static_cast<StateKey>(s.ball_vy_category + 1) << 30);
+}
+
+// Unpacks a 32-bit key back into a State.
+inline State decode_state(StateKey key) {
+    State s;
+    s.ball_x_grid = static_cast<int>(key & STATE_GRID_MASK);
+    s.ball_y_grid = static_cast<int>((key >> 7) & STATE_GRID_MASK);
+    s.cpu_paddle_y_grid = static_cast<int>((key >> 14) & STATE_GRID_MASK);
+    s.player_paddle_y_grid = static_cast<int>((key >> 21) & STATE_GRID_MASK);
+    s.ball_vx_category = static_cast<int>((key >> 28) & 0x3u) - 1;
+    s.ball_vy_category = static_cast<int>((key >> 30) & 0x3u) - 1;
+    return s;
+}
+
+// Key of the cell `level` levels coarser: every grid index halved `level` times (so each coarse
+// cell merges 2^level cells per grid axis), velocity categories unchanged. Shifting the packed
+// grid fields right together moves each field's low bits into the one below; the mask keeps
+// only each field's own top 7 - level bits. `level` is in [0, STATE_GRID_BITS).
+inline StateKey coarsen_key(StateKey key, int level) {
+    const StateKey field = STATE_GRID_MASK >> level;
+    const StateKey fields = field | (field << 7) | (field << 14) | (field << 21);
+    return (((key & 0x0FFFFFFFu) >> level) & fields) | (key & 0xF0000000u);
+}
+
+// Key of the vertically mirrored state on a grid with `grid_y` ball rows and `paddle_y` paddle
+// rows: ball y and both paddle cells flipped (cell i becomes rows - 1 - i), ball y velocity
+// negated, ball x and x velocity unchanged. The key's fields must lie inside that grid.
+inline StateKey mirror_key(StateKey key, int grid_y, int paddle_y) {
+    StateKey ball_y = (key >> 7) & STATE_GRID_MASK;
+    StateKey cpu_y = (key >> 14) & STATE_GRID_MASK;
+    StateKey player_y = (key >> 21) & STATE_GRID_MASK;
+    StateKey vy = key >> 30; // Category + 1, in 0..2
+    return (key & (STATE_GRID_MASK | 0x30000000u)) |
+           ((static_cast<StateKey>(grid_y - 1) - ball_y) << 7) |
+           ((static_cast<StateKey>(paddle_y - 1) - cpu_y) << 14) |
+           ((static_cast<StateKey>(paddle_y - 1) - player_y) << 21) |
+           ((2u - vy) << 30);
+}
+
+// True if every field of the State is in range for the packed key layout.
+inline bool state_fits_key(const State& s) {
+    return s.ball_x_grid >= 0 && s.ball_x_grid < STATE_MAX_DIVISIONS &&
+           s.ball_y_grid >= 0 && s.ball_y_grid < STATE_MAX_DIVISIONS &&
+           s.cpu_paddle_y_grid >= 0 && s.cpu_paddle_y_grid < STATE_MAX_DIVISIONS &&
+           s.player_paddle_y_grid >= 0 && s.player_paddle_y_grid < STATE_MAX_DIVISIONS &&
+           s.ball_vx_category >= -1 && s.ball_vx_category <= 1 &&
+           s.ball_vy_category >= -1 && s.ball_vy_category <= 1;
+}
+
+// Cell of a coordinate already multiplied by divisions / extent, clamped to [0, divisions - 1].
+// The clamp is done on the float (min/max compile to branchless instructions, and the conversion
+// stays defined far off the field); truncating a non-negative value is the same as flooring it.
+inline int discretize_scaled(float scaled, int divisions) {
+    return static_cast<int>(std::min(std::max(scaled, 0.0f), static_cast<float>(divisions - 1)));
+}
+
+// Velocity category of one axis: -1, 0 or 1 (branchless).
+inline int velocity_category(float velocity) {
+    return static_cast<int>(velocity > 0.0f) - static_cast<int>(velocity < 0.0f);
+}
+
+// --- Compile-time Discretization ---
+// A grid with its division counts and field size as template parameters (the field defaults to
+// the game's, from GameConstants.h). Everything that depends only on them (state-space size, the
+// radices of the dense index, the clamp bounds, the per-axis scales divisions / extent) is a
+// compile-time constant, so each axis costs a multiply by an immediate and a clamp. Several
+// resolutions can be compiled into one binary, each fully specialized (see QTableBench).
+// Produces exactly the States of the runtime discretize_state with the same sizes.
+template <int GridX, int GridY, int PaddleY,
+          unsigned int FieldWidth = WINDOW_WIDTH, unsigned int FieldHeight = WINDOW_HEIGHT>
+class Discretizer {
+    static_assert(GridX >= 1 && GridX <= STATE_MAX_DIVISIONS &&
+                  GridY >= 1 && GridY <= STATE_MAX_DIVISIONS &&
+                  PaddleY >= 1 && PaddleY <= STATE_MAX_DIVISIONS,
+                  "Division counts must fit the packed key layout");
+    static_assert(FieldWidth > 0 && FieldHeight > 0, "The field must have a size");
+
+public:
+    static constexpr int grid_x = GridX;
+    static constexpr int grid_y = GridY;
+    static constexpr int paddle_y = PaddleY;
+
+    // Number of distinct States this grid can produce.
+    static constexpr size_t state_space_size = static_cast<size_t>(GridX) * GridY * VELOCITY_CATEGORIES *
+                                               VELOCITY_CATEGORIES * PaddleY * PaddleY;
+
+    // Per-axis scales, computed in float exactly as discretize_state computes them
+    static constexpr float x_scale = static_cast<float>(GridX) / static_cast<float>(FieldWidth);
+    static constexpr float y_scale = static_cast<float>(GridY) / static_cast<float>(FieldHeight);
+    static constexpr float paddle_scale = static_cast<float>(PaddleY) / static_cast<float>(FieldHeight);
+
+    // Same arguments and result as discretize_state (without the field size, a template parameter).
+    static State discretize(float ball_x, float ball_y, float ball_vx, float ball_vy,
+                            float cpu_paddle_center_y, float player_paddle_center_y) {
+        State s;
+        s.ball_x_grid = discretize_scaled(ball_x * x_scale, GridX);
+        s.ball_y_grid = discretize_scaled(ball_y * y_scale, GridY);
+        s.ball_vx_category = velocity_category(ball_vx);
+        s.ball_vy_category = velocity_category(ball_vy);
+        s.cpu_paddle_y_grid = discretize_scaled(cpu_paddle_center_y * paddle_scale, PaddleY);
+        s.player_paddle_y_grid = discretize_scaled(player_paddle_center_y * paddle_scale, PaddleY);
+        return s;
+    }
+
+    // True if the State lies inside this grid (so index is valid).
+    static constexpr bool contains(const State& s) {
+        return s.ball_x_grid >= 0 && s.ball_x_grid < GridX &&
+               s.ball_y_grid >= 0 && s.ball_y_grid < GridY &&
+               s.ball_vx_category >= -1 && s.ball_vx_category <= 1 &&
+               s.ball_vy_category >= -1 && s.ball_vy_category <= 1 &&
+               s.cpu_paddle_y_grid >= 0 && s.cpu_paddle_y_grid < PaddleY &&
+               s.player_paddle_y_grid >= 0 && s.player_paddle_y_grid < PaddleY;
+    }
+
+    // Dense index of a State in [0, state_space_size) (mixed radix over all six fields).
+    static constexpr size_t index(const State& s) {
+        return ((((static_cast<size_t>(s.ball_x_grid) * GridY + static_cast<size_t>(s.ball_y_grid)) *
+                  VELOCITY_CATEGORIES + static_cast<size_t>(s.ball_vx_category + 1)) *
+                 VELOCITY_CATEGORIES + static_cast<size_t>(s.ball_vy_category + 1)) *
+                PaddleY + static_cast<size_t>(s.cpu_paddle_y_grid)) *
+               PaddleY + static_cast<size_t>(s.player_paddle_y_grid);
+    }
+};
+
+// The game's grid.
+typedef Discretizer<GRID_X_DIVISIONS, GRID_Y_DIVISIONS, PADDLE_Y_DIVISIONS> DefaultDiscretizer;
+static_assert(DefaultDiscretizer::state_space_size == STATE_SPACE_SIZE, "Default grid size mismatch");
+
+// Dense index of a State in [0, STATE_SPACE_SIZE) for the default discretization
+// (mixed radix over all six fields), used by flat per-state arrays such as GreedyPolicy.
+inline size_t state_index(const State& s) {
+    return DefaultDiscretizer::index(s);
+}
+
+// True if the State lies inside the default discretization (so state_index is valid).
+inline bool state_in_default_grid(const State& s) {
+    return DefaultDiscretizer::contains(s);
+}
+
+// Hash for packed keys. The key fields sit in fixed bit ranges, so an identity hash would
+// put neighbouring states in neighbouring buckets; this integer finalizer (two multiply-xorshift
+// rounds) spreads every input bit over the whole result.
+struct StateKeyHash {
+    size_t operator()(StateKey key) const noexcept {
+        std::uint32_t h = key;
+        h ^= h >> 16;
+        h *= 0x7feb352dU;
+        h ^= h >> 15;
+        h *= 0x846ca68bU;
+        h ^= h >> 16;
+        return static_cast<size_t>(h);
+    }
+};
+
+// --- Runtime Discretization ---
+// Grid sizes chosen at runtime (e.g. by the hyperparameter sweep). The game uses the default
+// sizes above. Each size must be in [1, STATE_MAX_DIVISIONS] to fit the packed key.
+struct Discretization {
+    int grid_x = GRID_X_DIVISIONS;
+    int grid_y = GRID_Y_DIVISIONS;
+    int paddle_y = PADDLE_Y_DIVISIONS;
+
+    // Number of distinct States this discretization can produce.
+    size_t state_space_size() const {
+        return static_cast<size_t>(grid_x) * grid_y * VELOCITY_CATEGORIES * VELOCITY_CATEGORIES *
+               paddle_y * paddle_y;
+    }
+
+    // True if every size fits the packed key layout.
+    bool is_valid() const {
+        return grid_x >= 1 && grid_x <= STATE_MAX_DIVISIONS &&
+               grid_y >= 1 && grid_y <= STATE_MAX_DIVISIONS &&
+               paddle_y >= 1 && paddle_y <= STATE_MAX_DIVISIONS;
+    }
+
+    bool is_default() const {
+        return grid_x == GRID_X_DIVISIONS && grid_y == GRID_Y_DIVISIONS && paddle_y == PADDLE_Y_DIVISIONS;
+    }
+
+    // True if the State lies inside this grid.
+    bool contains(const State& s) const {
+        return s.ball_x_grid >= 0 && s.ball_x_grid < grid_x &&
+               s.ball_y_grid >= 0 && s.ball_y_grid < grid_y &&
+               s.ball_vx_category >= -1 && s.ball_vx_category <= 1 &&
+               s.ball_vy_category >= -1 && s.ball_vy_category <= 1 &&
+               s.cpu_paddle_y_grid >= 0 && s.cpu_paddle_y_grid < paddle_y &&
+               s.player_paddle_y_grid >= 0 && s.player_paddle_y_grid < paddle_y;
+    }
+
+    // The sizes of a compile-time grid.
+    template <typename D>
+    static Discretization of() {
+        Discretization grid;
+        grid.grid_x = D::grid_x;
+        grid.grid_y = D::grid_y;
+        grid.paddle_y = D::paddle_y;
+        return grid;
+    }
+};
+
+// Converts continuous game quantities (pixels, pixels per second) into a discrete State.
+// Paddle positions are the vertical centers of the paddles.
+State discretize_state(float ball_x, float ball_y, float ball_vx, float ball_vy,
+                       float cpu_paddle_center_y, float player_paddle_center_y,
+                       float field_width, float field_height);
+
+// Same, with the grid sizes given at runtime.
+State discretize_state(float ball_x, float ball_y, float ball_vx, float ball_vy,
+                       float cpu_paddle_center_y, float player_paddle_center_y,
+                       float field_width, float field_height, const Discretization& grid);
+
+// --- Continuous Observation ---
+// The same quantities a State is built from, without the grid: positions as fractions of the
+// field, and the ball's direction of travel as a unit vector. Used by agents that generalize
+// across nearby situations themselves (see TileCodingAgent.h) instead of looking up grid cells.
+struct Observation {
+    float ball_x = 0.0f;          // [0, 1], left to right
+    float ball_y = 0.0f;          // [0, 1], top to bottom
+    float ball_vx = 0.0f;         // [-1, 1]; negative means moving away from the CPU paddle
+    float ball_vy = 0.0f;         // [-1, 1]; negative means moving up
+    float cpu_paddle_y = 0.0f;    // [0, 1], paddle center
+    float player_paddle_y = 0.0f; // [0, 1], paddle center
+    float ball_intercept_y = 0.0f; // [0, 1], where the ball will cross the CPU's side, bouncing off
+                                   // the top and bottom walls (via the far side if moving away)
+};
+
+// Everything an agent may look at when it decides: the same moment as a discretized State (for
+// the tabular agent) and as an Observation (for the function-approximation agents). See Agent.h.
+struct AgentView {
+    State state;
+    Observation observation;
+};
+
+// Converts continuous game quantities into an Observation (same arguments as discretize_state).
+Observation make_observation(float ball_x, float ball_y, float ball_vx, float ball_vy,
+                             float cpu_paddle_center_y, float player_paddle_center_y,
+                             float field_width, float field_height);
+
 // Hash function specialization for State: Needed for std::unordered_map.
-// This is a simple hash combination; more robust methods exist if collisions become an issue.
+// Hashes the packed key, so State and StateKey tables distribute identically.
 namespace std {
     template <>
     struct hash<State> {
         size_t operator()(const State& s) const noexcept {
-            size_t h1 = std::hash<int>{}(s.ball_x_grid);
-            size_t h2 = std::hash<int>{}(s.ball_y_grid);
-            size_t h3 = std::hash<int>{}(s.ball_vx_category);
-            size_t h4 = std::hash<int>{}(s.ball_vy_category);
-            size_t h5 = std::hash<int>{}(s.cpu_paddle_y_grid);
-            size_t h6 = std::hash<int>{}(s.player_paddle_y_grid);
-
-            // Combine hashes (using a common technique)
-            size_t seed = 0;
-            seed ^= h1 + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= h2 + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= h3 + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= h4 + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= h5 + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= h6 + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            return seed;
+            return StateKeyHash{}(encode_state(s));
         }
     };
 } // namespace std
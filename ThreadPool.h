@@ -0,0 +1,90 @@
+#ifndef PONG_THREADPOOL_H
+#define PONG_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef> // For size_t
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A fixed set of worker threads running submitted jobs in FIFO order. Used by the training
+// tools to run independent headless jobs on every core. The destructor finishes all queued
+// jobs before joining the workers.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable job_available;
+    bool stopping;
+
+    void worker_loop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                job_available.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return; // Stopping and nothing left to do
+                job = std::move(jobs.front());
+                jobs.pop();
+            }
+            job();
+        }
+    }
+
+public:
+    // Starts `thread_count` workers; 0 means one per hardware thread.
+    explicit ThreadPool(size_t thread_count = 0) : stopping(false) {
+        if (thread_count == 0) {
+            thread_count = default_thread_count();
+        }
+        workers.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i) {
+            workers.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        job_available.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queues `fn` and returns a future for its result (exceptions are passed through it).
+    template <typename Fn>
+    std::future<typename std::invoke_result<Fn>::type> submit(Fn fn) {
+        typedef typename std::invoke_result<Fn>::type Result;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(fn));
+        std::future<Result> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.emplace([task] { (*task)(); });
+        }
+        job_available.notify_one();
+        return result;
+    }
+
+    size_t size() const { return workers.size(); }
+
+    // One thread per hardware thread (at least one).
+    static size_t default_thread_count() {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        return hardware > 0 ? hardware : 1;
+    }
+};
+
+#endif // PONG_THREADPOOL_H
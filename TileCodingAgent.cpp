@@ -0,0 +1,197 @@
+#include "TileCodingAgent.h"
+#include <algorithm> // For std::max_element
+#include <cmath>     // For std::floor
+#include <fstream>   // For file I/O
+#include <iostream>  // For error messages
+#include <sstream>   // For string stream parsing
+#include <iomanip>   // For std::setprecision
+
+// Per-dimension shift of tiling t is (t * DISPLACEMENT[d] mod TILINGS) / TILINGS of a tile.
+// Odd, distinct displacements keep the tilings from lining up along any diagonal.
+static const int DISPLACEMENT[5] = {1, 3, 5, 7, 9};
+
+// Tile of a tiled coordinate in [0, 1]: 0..tiles (the extra tile holds the shifted edge)
+static size_t tile_coordinate(float value, int tiles, int tiling, int dimension) {
+    float shift = static_cast<float>((tiling * DISPLACEMENT[dimension]) % TILINGS) / TILINGS;
+    int tile = static_cast<int>(std::floor(value * tiles + shift));
+    return static_cast<size_t>(std::max(0, std::min(tiles, tile)));
+}
+
+// Constructor
+TileCodingAgent::TileCodingAgent(unsigned int seed)
+    : weights(static_cast<size_t>(TILINGS) * TILES_PER_TILING, TileWeights{{0.0f, 0.0f, 0.0f, 0.0f}}),
+      alpha(0.1), gamma(0.9), epsilon(0.1), // Easy parameters
+      update_count(0),
+      rng(seed),
+      exploration_distribution(0.0, 1.0),
+      action_distribution(0, NUM_ACTIONS - 1)
+{
+}
+
+// Set difficulty parameters (the same levels as the tabular agent)
+void TileCodingAgent::set_difficulty(DifficultyLevel level) {
+    switch (level) {
+        case DifficultyLevel::EASY:   set_parameters(0.1, 0.9, 0.1); break;
+        case DifficultyLevel::MEDIUM: set_parameters(0.2, 0.9, 0.2); break;
+        case DifficultyLevel::HARD:   set_parameters(0.2, 0.95, 0.4); break;
+    }
+}
+
+// Set learning parameters directly
+void TileCodingAgent::set_parameters(double new_alpha, double new_gamma, double new_epsilon) {
+    alpha = new_alpha;
+    gamma = new_gamma;
+    epsilon = new_epsilon;
+}
+
+// Active tile of every tiling
+TileCodingAgent::ActiveTiles TileCodingAgent::active_tiles(const Observation& o) {
+    float vy = (o.ball_vy + 1.0f) * 0.5f; // [-1, 1] -> [0, 1]
+    size_t direction = (o.ball_vx >= 0.0f) ? 1 : 0;
+    float ball_to_paddle = (o.ball_y - o.cpu_paddle_y + 1.0f) * 0.5f; // [-1, 1] -> [0, 1]
+    ActiveTiles tiles;
+    for (int t = 0; t < TILINGS; ++t) {
+        size_t index = tile_coordinate(o.ball_x, TILES_BALL_X, t, 0);
+        index = index * (TILES_BALL_Y + 1) + tile_coordinate(o.ball_y, TILES_BALL_Y, t, 1);
+        index = index * (TILES_BALL_VY + 1) + tile_coordinate(vy, TILES_BALL_VY, t, 2);
+        index = index * (TILES_BALL_TO_PADDLE + 1) + tile_coordinate(ball_to_paddle, TILES_BALL_TO_PADDLE, t, 3);
+        index = index * (TILES_PLAYER_PADDLE + 1) + tile_coordinate(o.player_paddle_y, TILES_PLAYER_PADDLE, t, 4);
+        index = index * 2 + direction;
+        tiles[t] = static_cast<size_t>(t) * TILES_PER_TILING + index;
+    }
+    return tiles;
+}
+
+// Sum the active tiles' weights (the inner loop is one 4-wide add per tiling)
+TileWeights TileCodingAgent::sum_weights(const ActiveTiles& tiles) const {
+    TileWeights sum{{0.0f, 0.0f, 0.0f, 0.0f}};
+    for (int t = 0; t < TILINGS; ++t) {
+        const TileWeights& tile = weights[tiles[t]];
+        for (int a = 0; a < 4; ++a) {
+            sum.w[a] += tile.w[a];
+        }
+    }
+    return sum;
+}
+
+// Q-values of an observation
+QValues TileCodingAgent::get_q_values(const Observation& observation) const {
+    TileWeights sum = sum_weights(active_tiles(observation));
+    return QValues{sum.w[0], sum.w[1], sum.w[2]};
+}
+
+// Greedy action (first maximum)
+Action TileCodingAgent::best_action(const Observation& observation) const {
+    QValues q = get_q_values(observation);
+    return static_cast<Action>(std::max_element(q.begin(), q.end()) - q.begin());
+}
+
+// Choose an action using epsilon-greedy
+Action TileCodingAgent::choose_action(const Observation& observation) {
+    if (exploration_distribution(rng) < epsilon) {
+        return static_cast<Action>(action_distribution(rng)); // Explore
+    }
+    QValues q = get_q_values(observation);
+    if (q[0] == q[1] && q[1] == q[2]) {
+        return static_cast<Action>(action_distribution(rng)); // Nothing learned here yet
+    }
+    return static_cast<Action>(std::max_element(q.begin(), q.end()) - q.begin());
+}
+
+// Update the weights using the Q-learning formula
+void TileCodingAgent::update_q_value(const Observation& old_observation, Action action, double reward,
+                                     const Observation& new_observation) {
+    update_q_value(old_observation, action, reward, new_observation, gamma);
+}
+
+// Update the weights with an explicit discount on the future value
+void TileCodingAgent::update_q_value(const Observation& old_observation, Action action, double reward,
+                                     const Observation& new_observation, double discount) {
+    int action_index = static_cast<int>(action);
+
+    QValues next_q_values = get_q_values(new_observation);
+    double max_future_q = *std::max_element(next_q_values.begin(), next_q_values.end());
+
+    ActiveTiles tiles = active_tiles(old_observation);
+    double old_q_value = sum_weights(tiles).w[action_index];
+
+    // Each tiling carries 1/TILINGS of the correction, so the sum moves by alpha * error
+    double error = reward + discount * max_future_q - old_q_value;
+    float step = static_cast<float>(alpha / TILINGS * error);
+    for (int t = 0; t < TILINGS; ++t) {
+        weights[tiles[t]].w[action_index] += step;
+    }
+    update_count++;
+}
+
+// Count tiles that have learned something
+size_t TileCodingAgent::get_active_tile_count() const {
+    size_t count = 0;
+    for (const TileWeights& tile : weights) {
+        count += (tile.w[0] != 0.0f || tile.w[1] != 0.0f || tile.w[2] != 0.0f);
+    }
+    return count;
+}
+
+// Save the non-zero tiles
+bool TileCodingAgent::save_weights(const std::string& filename) const {
+    std::ofstream outfile(filename);
+    if (!outfile.is_open()) {
+        std::cerr << "Error: Could not open file for saving tile weights: " << filename << std::endl;
+        return false;
+    }
+
+    // Header with the layout, so a file from a different layout is rejected on load,
+    // then one line per non-zero tile: tile_index weight_stay weight_up weight_down
+    outfile << "tiles " << TILINGS << " " << TILES_PER_TILING << "\n";
+    outfile << std::setprecision(9); // Round-trips a float
+    size_t saved = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        const TileWeights& tile = weights[i];
+        if (tile.w[0] != 0.0f || tile.w[1] != 0.0f || tile.w[2] != 0.0f) {
+            outfile << i << " " << tile.w[0] << " " << tile.w[1] << " " << tile.w[2] << "\n";
+            saved++;
+        }
+    }
+
+    outfile.close();
+    std::cout << "Tile weights saved to " << filename << " (" << saved << " tiles)" << std::endl;
+    return true;
+}
+
+// Load tiles saved by save_weights
+bool TileCodingAgent::load_weights(const std::string& filename) {
+    std::ifstream infile(filename);
+    if (!infile.is_open()) {
+        std::cerr << "Error: Could not open file for loading tile weights: " << filename << std::endl;
+        return false;
+    }
+
+    std::string magic;
+    int tilings = 0;
+    size_t tiles_per_tiling = 0;
+    if (!(infile >> magic >> tilings >> tiles_per_tiling) || magic != "tiles" ||
+        tilings != TILINGS || tiles_per_tiling != TILES_PER_TILING) {
+        std::cerr << "Error: " << filename << " was saved with a different tile layout." << std::endl;
+        return false;
+    }
+
+    std::fill(weights.begin(), weights.end(), TileWeights{{0.0f, 0.0f, 0.0f, 0.0f}});
+    std::string line;
+    std::getline(infile, line); // Rest of the header line
+    int errors = 0;
+    while (std::getline(infile, line)) {
+        std::stringstream ss(line);
+        size_t index = 0;
+        TileWeights tile{{0.0f, 0.0f, 0.0f, 0.0f}};
+        if (ss >> index >> tile.w[0] >> tile.w[1] >> tile.w[2] && index < weights.size()) {
+            weights[index] = tile;
+        } else if (!line.empty()) {
+            errors++;
+        }
+    }
+    if (errors > 0) {
+        std::cerr << "Warning: Skipped " << errors << " malformed lines in " << filename << std::endl;
+    }
+    return true;
+}
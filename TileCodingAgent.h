@@ -0,0 +1,120 @@
+#ifndef PONG_TILECODINGAGENT_H
+#define PONG_TILECODINGAGENT_H
+
+#include "State.h"
+#include "QLearningAgent.h" // For Action, QValues, DifficultyLevel
+#include <array>
+#include <cstddef> // For size_t
+#include <random>
+#include <string>
+#include <vector>
+
+// --- Tile coding layout ---
+// Each tiling is a coarse grid over the continuous Observation; every tiling is shifted by a
+// different fraction of a tile, so two observations share some tiles when they are close and
+// none when they are far apart. The tiles per dimension below count tiles across [0, 1]; each
+// tiling has one extra tile per dimension to cover its shifted edge. The ball's x direction is
+// not tiled: moving toward or away from the CPU are learned separately.
+//
+// Instead of the CPU paddle's absolute position, the tilings cover the ball's height relative to
+// it (ball_y - cpu_paddle_y, mapped to [0, 1]): "the ball is above me" generalizes across the
+// whole field, which is what lets this agent learn faster than the grid. At these sizes the
+// weights take about as much memory as the tabular agent's pre-sized Q-table (~5 MB).
+const int TILINGS = 8;
+const int TILES_BALL_X = 8;
+const int TILES_BALL_Y = 8;
+const int TILES_BALL_VY = 4;
+const int TILES_BALL_TO_PADDLE = 16;
+const int TILES_PLAYER_PADDLE = 2;
+
+// Tiles in one tiling (including the extra edge tile per tiled dimension, times 2 x directions).
+const size_t TILES_PER_TILING = static_cast<size_t>(TILES_BALL_X + 1) * (TILES_BALL_Y + 1) *
+                                (TILES_BALL_VY + 1) * (TILES_BALL_TO_PADDLE + 1) *
+                                (TILES_PLAYER_PADDLE + 1) * 2;
+
+// Weights of one tile: one per action, padded to four floats so a tile is one aligned 16-byte
+// block and summing the active tiles is a single 4-wide vector add per tiling.
+struct alignas(16) TileWeights {
+    float w[4];
+};
+
+// Q-learning with linear function approximation over tile-coded observations:
+//   Q(s, a) = sum over tilings t of weight[active_tile(t, s)][a]
+// Nearby observations share tiles, so an update in one situation also moves the values of
+// similar ones, and the agent generalizes across the cells a tabular agent would learn one by
+// one. All weights live in one contiguous array (TILINGS * TILES_PER_TILING blocks).
+//
+// Same choose/update interface as QLearningAgent, with an Observation instead of a State.
+class TileCodingAgent {
+private:
+    std::vector<TileWeights> weights;
+
+    // Learning parameters (same meaning as in QLearningAgent; alpha is split across the tilings)
+    double alpha;
+    double gamma;
+    double epsilon;
+
+    long update_count; // Updates applied so far
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> exploration_distribution;
+    std::uniform_int_distribution<int> action_distribution;
+
+    // Index of the active tile of every tiling for an observation.
+    typedef std::array<size_t, TILINGS> ActiveTiles;
+    static ActiveTiles active_tiles(const Observation& observation);
+
+    // Sum of the active tiles' weights, for all actions at once (lane 3 is padding).
+    TileWeights sum_weights(const ActiveTiles& tiles) const;
+
+public:
+    // Constructor with a fixed random seed. Starts with the EASY parameters and all weights zero.
+    explicit TileCodingAgent(unsigned int seed = std::random_device{}());
+
+    // Same levels as QLearningAgent::set_difficulty (silently; the game reports the level once).
+    void set_difficulty(DifficultyLevel level);
+
+    // Sets alpha, gamma and epsilon directly.
+    void set_parameters(double new_alpha, double new_gamma, double new_epsilon);
+
+    // Re-seeds the exploration random number generator.
+    void seed(unsigned int seed) { rng.seed(seed); }
+
+    // Epsilon-greedy action for an observation. Observations whose values are all equal (e.g.
+    // never updated) get a random action, like unseen states in QLearningAgent.
+    Action choose_action(const Observation& observation);
+
+    // Greedy action (no exploration, first maximum on ties).
+    Action best_action(const Observation& observation) const;
+
+    // Q-values of all actions for an observation.
+    QValues get_q_values(const Observation& observation) const;
+
+    // Q-learning update of the action's weights in every active tile:
+    //   w += (alpha / TILINGS) * [reward + gamma * max Q(s', .) - Q(s, a)]
+    void update_q_value(const Observation& old_observation, Action action, double reward,
+                        const Observation& new_observation);
+
+    // Same update with an explicit discount instead of gamma (see SemiMdp.h).
+    void update_q_value(const Observation& old_observation, Action action, double reward,
+                        const Observation& new_observation, double discount);
+
+    // Saves the non-zero tiles to a text file / loads them back.
+    bool save_weights(const std::string& filename) const;
+    bool load_weights(const std::string& filename);
+
+    double get_alpha() const { return alpha; }
+    double get_gamma() const { return gamma; }
+    double get_epsilon() const { return epsilon; }
+
+    // Number of updates applied since construction.
+    long get_update_count() const { return update_count; }
+
+    // Tiles with at least one non-zero weight.
+    size_t get_active_tile_count() const;
+
+    // Bytes used by the weight array.
+    size_t memory_bytes() const { return weights.size() * sizeof(TileWeights); }
+};
+
+#endif // PONG_TILECODINGAGENT_H
@@ -0,0 +1,148 @@
+#include "TrainingJob.h"
+#include "Simulation.h"
+#include "ScriptedOpponent.h"
+#include "SemiMdp.h"
+#include <chrono>
+
+// Upper bound on steps per evaluation point, in case both paddles keep returning forever
+static const long MAX_STEPS_PER_POINT = 20000;
+
+// --- Per-agent adapters for the shared training loop ---
+// (What the agent sees and how big its model is come from AgentTraits, see Agent.h)
+
+// Applies the config's learning parameters
+static void configure(QLearningAgent& agent, const TrainingConfig& config) {
+    agent.set_parameters(config.alpha, config.gamma, config.epsilon);
+    agent.set_learning_rate_exponent(config.learning_rate_exponent);
+    agent.set_exploration_bonus(config.exploration_bonus);
+    if (agent.get_coarse_levels() != config.coarse_levels || agent.get_refine_visits() != config.refine_visits) {
+        agent.set_coarse_levels(config.coarse_levels, config.refine_visits); // Once: this rebuilds the levels
+    }
+    if (agent.get_mirror_symmetry() != config.mirror_symmetry) {
+        agent.set_mirror_symmetry(config.mirror_symmetry, config.grid); // Once: this refolds the table
+    }
+    bool dyna = config.planning_updates > 0 || config.planning_microseconds > 0.0;
+    if (agent.get_dyna_enabled() != dyna || agent.get_planning_updates() != config.planning_updates ||
+        agent.get_planning_microseconds() != config.planning_microseconds) {
+        agent.set_dyna_planning(dyna, config.planning_updates, config.planning_microseconds);
+    }
+}
+
+// (The function-approximation agents only have alpha, gamma and epsilon)
+template <typename A>
+static void configure(A& agent, const TrainingConfig& config) {
+    agent.set_parameters(config.alpha, config.gamma, config.epsilon);
+}
+
+// One training step's update. Only the tabular agent has a semi-MDP mode.
+static void learn(QLearningAgent& agent, SemiMdpAccumulator& transition, const TrainingConfig& config,
+                  const State& state, Action action, double reward, const State& next_state, bool point_over) {
+    if (config.semi_mdp) {
+        transition.observe(agent, state, action, reward, next_state, config.dt);
+        if (point_over) transition.flush(agent);
+    } else {
+        agent.update_q_value(state, action, reward, next_state);
+    }
+}
+
+template <typename A>
+static void learn(A& agent, SemiMdpAccumulator&, const TrainingConfig&,
+                  const Observation& observation, Action action, double reward,
+                  const Observation& next_observation, bool) {
+    agent.update_q_value(observation, action, reward, next_observation);
+}
+
+// Applies the semi-MDP transition still pending when training stops (none outside semi-MDP mode)
+static void finish_learning(QLearningAgent& agent, SemiMdpAccumulator& transition) {
+    transition.flush(agent);
+}
+
+template <typename A>
+static void finish_learning(A&, SemiMdpAccumulator&) {}
+
+// Greedy-action cache counters (only the tabular agent has the cache)
+static long action_cache_hits(const QLearningAgent& agent) { return agent.get_action_cache_hits(); }
+static long action_cache_misses(const QLearningAgent& agent) { return agent.get_action_cache_misses(); }
+
+template <typename A>
+static long action_cache_hits(const A&) { return 0; }
+template <typename A>
+static long action_cache_misses(const A&) { return 0; }
+
+// Train, then evaluate greedily
+template <typename A>
+static TrainingResult train_and_evaluate(const TrainingConfig& config, A& agent) {
+    typedef AgentTraits<A> Traits;
+    typedef typename Traits::Input Input;
+    TrainingResult result;
+    auto start = std::chrono::steady_clock::now();
+
+    Simulation world(config.seed);
+    world.setDiscretization(config.grid);
+    ScriptedOpponent opponent(config.opponent_skill, config.seed + 1);
+    configure(agent, config);
+
+    // --- Training ---
+    SemiMdpAccumulator transition;
+    long updates_before = agent.get_update_count();
+    long cache_hits_before = action_cache_hits(agent);
+    long cache_misses_before = action_cache_misses(agent);
+    long window_points = 0;
+    long window_wins = 0;
+    for (long step = 1; step <= config.steps; ++step) {
+        Input state = world.getRightInput<Input>();
+        Action action = agent.choose_action(state);
+        StepEvents events = world.step(config.dt, opponent.chooseAction(world, true), action);
+        Input next_state = world.getRightInput<Input>();
+        double reward = compute_step_reward(events, true, action, next_state);
+        learn(agent, transition, config, state, action, reward, next_state, events.scoreEvent != 0);
+
+        if (events.scoreEvent != 0) {
+            result.training_points++;
+            window_points++;
+            window_wins += (events.scoreEvent == -1); // The agent (right) scored
+        }
+        if (step % config.window_steps == 0) {
+            if (result.steps_to_threshold < 0 && window_points > 0 &&
+                static_cast<double>(window_wins) / window_points >= config.win_threshold) {
+                result.steps_to_threshold = step;
+            }
+            window_points = 0;
+            window_wins = 0;
+        }
+    }
+    finish_learning(agent, transition);
+    result.table_size = Traits::model_size(agent);
+    result.memory_bytes = Traits::model_bytes(agent);
+    result.updates = agent.get_update_count() - updates_before;
+    result.action_cache_hits = action_cache_hits(agent) - cache_hits_before;
+    result.action_cache_misses = action_cache_misses(agent) - cache_misses_before;
+
+    // --- Greedy evaluation (no exploration, no learning) ---
+    // best_action has no side effects: unseen states and ties get the same deterministic answer
+    // as in Evaluation.cpp, and the agent's random numbers are left where training stopped.
+    world.reset();
+    long points = 0;
+    long wins = 0;
+    long step_budget = config.evaluation_points * MAX_STEPS_PER_POINT;
+    for (long step = 0; points < config.evaluation_points && step < step_budget; ++step) {
+        Action action = agent.best_action(world.getRightInput<Input>());
+        StepEvents events = world.step(config.dt, opponent.chooseAction(world, true), action);
+        if (events.scoreEvent != 0) {
+            points++;
+            wins += (events.scoreEvent == -1);
+        }
+    }
+    result.final_win_rate = points > 0 ? static_cast<double>(wins) / points : 0.0;
+
+    result.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+TrainingResult run_training_job(const TrainingConfig& config, Agent& agent) {
+    return visit_agent(agent, [&config](auto& concrete) { return train_and_evaluate(config, concrete); });
+}
+
+TrainingResult run_training_job(const TrainingConfig& config, QLearningAgent& agent) {
+    return train_and_evaluate(config, agent);
+}
@@ -0,0 +1,54 @@
+#ifndef PONG_TRAININGJOB_H
+#define PONG_TRAININGJOB_H
+
+#include "State.h"
+#include "Agent.h"
+#include <string>
+
+// One headless training run: a Q-learning agent on the right paddle learns against a
+// ScriptedOpponent on the left, then plays greedily (no exploration, no learning) for a final
+// win-rate measurement. Used by the hyperparameter sweep, one job per configuration.
+// The agent is tabular (QLearningAgent), tile-coded (TileCodingAgent), linear (LinearAgent) or a
+// neural network (DqnAgent); the count-based schedules, semi-MDP updates, hierarchy and grid only apply to the tabular one.
+struct TrainingConfig {
+    double alpha = 0.1;
+    double gamma = 0.9;
+    double epsilon = 0.1;
+    double learning_rate_exponent = 0.0; // Count-based learning rate (see QLearningAgent); 0 = fixed alpha
+    double exploration_bonus = 0.0;      // UCB exploration weight; 0 = plain epsilon-greedy
+    bool semi_mdp = false;               // Update once per change of discretized state (see SemiMdp.h)
+    int coarse_levels = 0;               // Coarse-to-fine hierarchy depth (see QLearningAgent); 0 = flat table
+    int refine_visits = 0;               // Updates of a level-1 cell before its states get their own rows
+    bool mirror_symmetry = false;        // Mirrored states share one table row (see QLearningAgent)
+    int planning_updates = 0;            // Dyna-Q simulated updates per real one (see QLearningAgent); 0 = none
+    double planning_microseconds = 0.0;  // Time limit on them per real update; 0 = none
+    AgentKind agent = AgentKind::QTable; // Which agent the caller trains (see run_training_job)
+    Discretization grid;            // State discretization used by the agent
+    long steps = 2000000;           // Training steps
+    long window_steps = 100000;     // Win rate during training is tracked over windows of this many steps
+    double win_threshold = 0.5;     // Training win rate that counts as "learned"
+    long evaluation_points = 500;   // Points played greedily for the final win rate
+    float dt = 1.0f / 60.0f;        // Seconds per step
+    float opponent_skill = 0.5f;    // See ScriptedOpponent
+    unsigned int seed = 1;          // Seeds the ball and the opponent (the agent is seeded by the caller)
+};
+
+struct TrainingResult {
+    double final_win_rate = 0.0;   // Fraction of evaluation points won by the agent
+    long steps_to_threshold = -1;  // End of the first window whose win rate reached the threshold (-1 = never)
+    size_t table_size = 0;         // States in the Q-table (tiles with non-zero weights, or weights) after training
+    size_t memory_bytes = 0;       // Memory of the learned table or weights
+    long training_points = 0;      // Points played during training
+    long updates = 0;              // Q-value updates applied during training
+    long action_cache_hits = 0;    // Training decisions answered by the Q-table's greedy-action cache
+    long action_cache_misses = 0;  // Greedy decisions it had to look up (both 0 for the other agents)
+    double wall_seconds = 0.0;     // Time spent in the job (training and evaluation)
+};
+
+// Trains `agent` in place with the config's parameters and grid and measures the result.
+// Thread-safe as long as each concurrent job gets its own agent. The training loop is compiled
+// per agent type (see visit_agent), so an Agent costs one virtual call per job, not per step.
+TrainingResult run_training_job(const TrainingConfig& config, Agent& agent);
+TrainingResult run_training_job(const TrainingConfig& config, QLearningAgent& agent);
+
+#endif // PONG_TRAININGJOB_H
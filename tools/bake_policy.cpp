@@ -0,0 +1,72 @@
+// Build-time tool: compiles a saved Q-table into its greedy policy and writes it out as C++
+// source (BakedPolicyData.inc), so the game starts with a trained opponent without reading
+// or parsing any file.
+//
+// Usage: BakePolicy <output.inc> [q_table_file]
+// Without a Q-table file the output declares that no policy is baked in.
+#include "State.h"
+#include "QLearningAgent.h"
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 2-bit code for states the Q-table has never seen
+const std::uint8_t UNSEEN_CODE = 3;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <output.inc> [q_table_file]" << std::endl;
+        return 1;
+    }
+    std::string output_path = argv[1];
+    std::string table_path = (argc == 3) ? argv[2] : "";
+
+    // One 2-bit code per dense state index: the greedy action, or UNSEEN_CODE
+    std::vector<std::uint8_t> codes(STATE_SPACE_SIZE, UNSEEN_CODE);
+    size_t known_states = 0;
+    if (!table_path.empty()) {
+        QLearningAgent agent;
+        if (!agent.load_q_table(table_path)) {
+            return 1; // The load already reported the error
+        }
+        agent.get_q_table().for_each([&](StateKey key, const QRow&) {
+            State s = decode_state(key);
+            if (!state_in_default_grid(s)) return;
+            QValues q_values = agent.get_q_values(key);
+            int best = 0;
+            for (int i = 1; i < NUM_ACTIONS; ++i) {
+                if (q_values[i] > q_values[best]) best = i; // First maximum, like the agent
+            }
+            codes[state_index(s)] = static_cast<std::uint8_t>(best);
+            known_states++;
+        });
+    }
+
+    // Pack four states per byte, lowest state index in the lowest bits
+    std::vector<std::uint8_t> packed((codes.size() + 3) / 4, 0);
+    for (size_t i = 0; i < codes.size(); ++i) {
+        packed[i / 4] |= static_cast<std::uint8_t>(codes[i] << ((i % 4) * 2));
+    }
+
+    std::ofstream out(output_path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open output file: " << output_path << std::endl;
+        return 1;
+    }
+    out << "// Generated by BakePolicy" << (table_path.empty() ? "" : " from " + table_path) << ". Do not edit.\n";
+    out << "// Greedy action per dense state index, 2 bits each (3 = unseen state). constexpr, so\n";
+    out << "// lookups with constant indices fold at compile time.\n";
+    out << "inline constexpr bool BAKED_POLICY_AVAILABLE = " << (known_states > 0 ? "true" : "false") << ";\n";
+    out << "inline constexpr size_t BAKED_POLICY_STATE_COUNT = " << codes.size() << ";\n";
+    out << "inline constexpr size_t BAKED_POLICY_KNOWN_STATES = " << known_states << ";\n";
+    out << "inline constexpr std::uint8_t BAKED_POLICY_DATA[" << packed.size() << "] = {";
+    for (size_t i = 0; i < packed.size(); ++i) {
+        out << (i % 20 == 0 ? "\n    " : " ") << static_cast<int>(packed[i]) << ",";
+    }
+    out << "\n};\n";
+
+    std::cout << "Baked policy with " << known_states << " known states into " << output_path << std::endl;
+    return 0;
+}
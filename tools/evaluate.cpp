@@ -0,0 +1,111 @@
+// Evaluates a saved agent: plays seeded headless matches of its greedy policy (no learning,
+// no exploration) against scripted opponents on all cores and reports win rate, rally length
+// and points per match with 95% confidence intervals. Results depend only on the saved agent,
+// the options and the seed, not on the number of threads.
+//
+// Usage: Evaluate [file] [options]
+//   file              saved Q-table or weights to evaluate (default: where the game saves the
+//                     chosen agent, e.g. pong_q_table.dat)
+//   --agent NAME      table, tiles, linear or dqn (default table)
+//   --matches N       maximum number of matches (default 2000)
+//   --min-matches N   never stop before this many (default 100)
+//   --precision H     stop once the win-rate interval is +/- H (default 0.02)
+//   --skills LIST     comma-separated scripted opponent skills (default 0.3,0.5,0.7)
+//   --points N        points to win a match (default 10)
+//   --threads N       worker threads (default: one per hardware thread)
+//   --seed N          random seed (default 1)
+#include "Evaluation.h"
+#include "Agent.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+static void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [file] [--agent NAME] [--matches N] [--min-matches N] [--precision H]"
+              << " [--skills LIST] [--points N] [--threads N] [--seed N]" << std::endl;
+}
+
+static void print_estimate(const char* name, const Estimate& e) {
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(8) << e.mean << "  [" << e.low << ", " << e.high << "]" << std::defaultfloat << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    EvaluationConfig config;
+    std::string table_path; // Default depends on the agent
+    AgentKind kind = AgentKind::QTable;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            table_path = arg;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--matches") config.max_matches = std::atol(value.c_str());
+        else if (arg == "--min-matches") config.min_matches = std::atol(value.c_str());
+        else if (arg == "--precision") config.target_half_width = std::atof(value.c_str());
+        else if (arg == "--points") config.points_to_win = std::atoi(value.c_str());
+        else if (arg == "--threads") config.threads = static_cast<size_t>(std::atol(value.c_str()));
+        else if (arg == "--seed") config.seed = static_cast<unsigned int>(std::atol(value.c_str()));
+        else if (arg == "--agent") {
+            if (!parse_agent_kind(value, kind)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg == "--skills") {
+            config.opponent_skills.clear();
+            std::istringstream in(value);
+            std::string item;
+            while (std::getline(in, item, ',')) {
+                config.opponent_skills.push_back(static_cast<float>(std::atof(item.c_str())));
+            }
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (config.opponent_skills.empty() || config.points_to_win < 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::unique_ptr<Agent> agent = make_agent(kind, config.seed);
+    if (table_path.empty()) table_path = agent->file_name();
+    if (!agent->load(table_path)) {
+        return 1; // The load already reported the error
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    EvaluationSummary summary;
+    if (kind == AgentKind::QTable) {
+        // A table plays fastest compiled to one byte per state
+        summary = evaluate_policy(GreedyPolicy::compile(concrete_agent<QLearningAgent>(*agent)), config);
+    } else {
+        summary = evaluate_agent(*agent, config);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << summary.matches << " matches to " << config.points_to_win << " points"
+              << (summary.stopped_early ? " (stopped early, interval reached target)" : "")
+              << ", " << seconds << " s" << std::endl;
+    std::cout << "95% confidence intervals:" << std::endl;
+    print_estimate("win rate", summary.win_rate);
+    print_estimate("returns per point", summary.rally_length);
+    print_estimate("points won / match", summary.points_won);
+    print_estimate("points lost / match", summary.points_lost);
+    for (size_t k = 0; k < config.opponent_skills.size(); ++k) {
+        std::ostringstream name;
+        name << "win rate vs skill " << config.opponent_skills[k];
+        print_estimate(name.str().c_str(), summary.win_rate_by_opponent[k]);
+    }
+    return 0;
+}
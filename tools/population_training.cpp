@@ -0,0 +1,100 @@
+// Population-based training: a population of headless agents trains in parallel against the
+// scripted opponent; weak members periodically take over (copy) the Q-table and
+// hyperparameters of strong ones and perturb them (see PopulationTraining.h). The best
+// member's Q-table is saved in the game's format.
+//
+// Usage: PopulationTraining [options]
+//   --population N    members (default: twice the number of threads, at least 4)
+//   --interval N      training steps between exploit/explore decisions (default 200000)
+//   --intervals N     intervals per member (default 20)
+//   --exploit F       bottom fraction that copies from the top fraction (default 0.25)
+//   --perturb F       hyperparameter perturbation factor (default 0.2)
+//   --alpha A --gamma G --epsilon E   starting hyperparameters (default 0.1, 0.9, 0.1)
+//   --skill S         scripted opponent skill (default 0.5)
+//   --threads N       worker threads (default: one per hardware thread)
+//   --seed N          random seed (default 1)
+//   --load FILE       start every member from this Q-table (read once)
+//   --out FILE        where to save the best table (default pbt_q_table.dat)
+#include "PopulationTraining.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+static void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--population N] [--interval N] [--intervals N] [--exploit F]"
+              << " [--perturb F] [--alpha A] [--gamma G] [--epsilon E] [--skill S] [--threads N] [--seed N]"
+              << " [--load FILE] [--out FILE]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    PopulationConfig config;
+    size_t population = 0;
+    std::string load_path;
+    std::string out_path = "pbt_q_table.dat";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--population") population = static_cast<size_t>(std::atol(value));
+        else if (arg == "--interval") config.interval_steps = std::atol(value);
+        else if (arg == "--intervals") config.intervals = std::atoi(value);
+        else if (arg == "--exploit") config.exploit_fraction = std::atof(value);
+        else if (arg == "--perturb") config.perturb_factor = std::atof(value);
+        else if (arg == "--alpha") config.base.alpha = std::atof(value);
+        else if (arg == "--gamma") config.base.gamma = std::atof(value);
+        else if (arg == "--epsilon") config.base.epsilon = std::atof(value);
+        else if (arg == "--skill") config.base.opponent_skill = static_cast<float>(std::atof(value));
+        else if (arg == "--threads") config.threads = static_cast<size_t>(std::atol(value));
+        else if (arg == "--seed") config.seed = static_cast<unsigned int>(std::atol(value));
+        else if (arg == "--load") load_path = value;
+        else if (arg == "--out") out_path = value;
+        else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (config.interval_steps < 1 || config.intervals < 1) {
+        std::cerr << "Error: --interval and --intervals must be positive." << std::endl;
+        return 1;
+    }
+    size_t threads = config.threads ? config.threads : ThreadPool::default_thread_count();
+    config.population = population ? population : std::max<size_t>(4, 2 * threads);
+
+    QLearningAgent initial_agent(config.seed);
+    if (!load_path.empty() && !initial_agent.load_q_table(load_path)) {
+        return 1; // The load already reported the error
+    }
+
+    std::cout << "Population-based training: " << config.population << " members x " << config.intervals
+              << " intervals of " << config.interval_steps << " steps on " << threads << " thread"
+              << (threads == 1 ? "" : "s") << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    PopulationTrainer trainer(config, initial_agent);
+    trainer.run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::left << std::setw(8) << "member" << std::setw(10) << "alpha" << std::setw(10) << "gamma"
+              << std::setw(10) << "epsilon" << std::right << std::setw(9) << "win rate" << std::setw(10) << "exploits"
+              << std::setw(9) << "states" << std::endl;
+    const std::vector<PopulationMember>& members = trainer.get_members();
+    for (size_t i = 0; i < members.size(); ++i) {
+        const PopulationMember& m = members[i];
+        std::cout << std::left << std::setw(8) << i << std::setprecision(4) << std::setw(10) << m.config.alpha
+                  << std::setw(10) << m.config.gamma << std::setw(10) << m.config.epsilon << std::right
+                  << std::fixed << std::setprecision(3) << std::setw(9) << m.score << std::defaultfloat
+                  << std::setw(10) << m.exploits << std::setw(9) << m.agent.get_explored_state_count() << std::endl;
+    }
+    const PopulationMember& best = trainer.best();
+    std::cout << "Best win rate " << best.score << " after " << best.steps << " training steps behind its table; "
+              << "total wall time " << seconds << " s" << std::endl;
+
+    // The save reports success or failure itself
+    return best.agent.save_q_table(out_path) ? 0 : 1;
+}
@@ -0,0 +1,812 @@
+// Q-table analysis and benchmark tool.
+// Reports hash quality (collisions, bucket occupancy, linear-probe lengths) and lookup cost
+// for the packed StateKey against the original six-field State hash, and compares the
+// open-addressing QTable with std::unordered_map, including worst-case per-call latency while
+// the table grows, measures how well reduced-precision Q-value storage agrees with double, and
+// checks the agent's action cache (hit rate, and identical choices to an uncached agent), and
+// times the neural network agent's batched inference and training against the Q-table, and
+// compares the compile-time Discretizer at several resolutions with the runtime discretize_state.
+#include "State.h"
+#include "QTable.h"
+#include "QValueStorage.h"
+#include "QLearningAgent.h"
+#include "SemiMdp.h"
+#include "DqnAgent.h"
+#include "GameConstants.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// The State hash used before packed keys: six std::hash<int> calls (identity on libstdc++)
+// combined with the boost-style mixer.
+struct LegacyStateHash {
+    size_t operator()(const State& s) const noexcept {
+        size_t seed = 0;
+        seed ^= std::hash<int>{}(s.ball_x_grid) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<int>{}(s.ball_y_grid) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<int>{}(s.ball_vx_category) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<int>{}(s.ball_vy_category) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<int>{}(s.cpu_paddle_y_grid) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<int>{}(s.player_paddle_y_grid) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
+
+// Every state of a grid with the given divisions
+static std::vector<State> enumerate_states(int grid_x, int grid_y, int paddle_y) {
+    std::vector<State> states;
+    states.reserve(static_cast<size_t>(grid_x) * grid_y * paddle_y * paddle_y * 9);
+    State s;
+    for (s.ball_x_grid = 0; s.ball_x_grid < grid_x; ++s.ball_x_grid)
+    for (s.ball_y_grid = 0; s.ball_y_grid < grid_y; ++s.ball_y_grid)
+    for (s.ball_vx_category = -1; s.ball_vx_category <= 1; ++s.ball_vx_category)
+    for (s.ball_vy_category = -1; s.ball_vy_category <= 1; ++s.ball_vy_category)
+    for (s.cpu_paddle_y_grid = 0; s.cpu_paddle_y_grid < paddle_y; ++s.cpu_paddle_y_grid)
+    for (s.player_paddle_y_grid = 0; s.player_paddle_y_grid < paddle_y; ++s.player_paddle_y_grid)
+        states.push_back(s);
+    return states;
+}
+
+// Random states spread over the full 128-division key space
+static std::vector<State> sample_states(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> grid(0, STATE_MAX_DIVISIONS - 1);
+    std::uniform_int_distribution<int> category(-1, 1);
+    std::unordered_set<StateKey> seen;
+    std::vector<State> states;
+    while (states.size() < count) {
+        State s;
+        s.ball_x_grid = grid(rng);
+        s.ball_y_grid = grid(rng);
+        s.ball_vx_category = category(rng);
+        s.ball_vy_category = category(rng);
+        s.cpu_paddle_y_grid = grid(rng);
+        s.player_paddle_y_grid = grid(rng);
+        if (seen.insert(encode_state(s)).second) {
+            states.push_back(s);
+        }
+    }
+    return states;
+}
+
+static size_t next_power_of_two(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Hash quality for one hash function over a set of states
+template <typename HashFn>
+static void report_hash(const std::string& name, const std::vector<State>& states, HashFn hash) {
+    std::vector<size_t> hashes(states.size());
+    for (size_t i = 0; i < states.size(); ++i) hashes[i] = hash(states[i]);
+
+    // Full-width collisions
+    std::vector<size_t> sorted = hashes;
+    std::sort(sorted.begin(), sorted.end());
+    size_t distinct = static_cast<size_t>(std::unique(sorted.begin(), sorted.end()) - sorted.begin());
+
+    // Bucket occupancy in a power-of-two table at load factor 1 (low bits select the bucket)
+    size_t buckets = next_power_of_two(states.size());
+    std::vector<int> occupancy(buckets, 0);
+    for (size_t h : hashes) occupancy[h & (buckets - 1)]++;
+    size_t empty = static_cast<size_t>(std::count(occupancy.begin(), occupancy.end(), 0));
+    int max_bucket = *std::max_element(occupancy.begin(), occupancy.end());
+
+    std::cout << std::left << std::setw(10) << name
+              << " distinct=" << distinct << "/" << states.size()
+              << "  empty buckets=" << std::fixed << std::setprecision(1)
+              << 100.0 * empty / buckets << "% (ideal "
+              << 100.0 * std::exp(-static_cast<double>(states.size()) / buckets) << "%)"
+              << "  max bucket=" << max_bucket;
+
+    // Linear probing in an open-addressing table at two load factors
+    for (double load : {0.5, 0.875}) {
+        // Largest power-of-two table that the states can fill to the target load
+        size_t capacity = next_power_of_two(states.size());
+        while (capacity * load > states.size()) capacity >>= 1;
+        size_t count = static_cast<size_t>(capacity * load);
+        std::vector<bool> used(capacity, false);
+        size_t total_probes = 0;
+        size_t max_probes = 0;
+        for (size_t i = 0; i < count; ++i) {
+            size_t slot = hashes[i] & (capacity - 1);
+            size_t probes = 1;
+            while (used[slot]) {
+                slot = (slot + 1) & (capacity - 1);
+                probes++;
+            }
+            used[slot] = true;
+            total_probes += probes;
+            max_probes = std::max(max_probes, probes);
+        }
+        std::cout << "  probes@" << std::setprecision(3) << load << " avg="
+                  << std::setprecision(2) << static_cast<double>(total_probes) / count
+                  << " max=" << max_probes;
+    }
+    std::cout << std::endl;
+}
+
+// Timed loops add what they read into this, so the compiler cannot drop them as unused
+static volatile double bench_sink = 0.0;
+
+// Time `rounds` passes of find() over every state
+template <typename Map, typename KeyFn>
+static double time_lookups(const Map& map, const std::vector<State>& order, KeyFn key, int rounds) {
+    double checksum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (const State& s : order) {
+            auto it = map.find(key(s));
+            if (it != map.end()) checksum += it->second[0];
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    bench_sink = bench_sink + checksum;
+    return ns / (static_cast<double>(order.size()) * rounds);
+}
+
+static void analyze_hashes() {
+    std::cout << "=== State key hashing ===" << std::endl;
+    std::cout << "sizeof(State)=" << sizeof(State) << " bytes, sizeof(StateKey)=" << sizeof(StateKey) << " bytes" << std::endl;
+
+    std::vector<State> default_states = enumerate_states(GRID_X_DIVISIONS, GRID_Y_DIVISIONS, PADDLE_Y_DIVISIONS);
+    std::vector<State> fine_states = sample_states(1 << 20, 1234);
+
+    auto packed = [](const State& s) { return StateKeyHash{}(encode_state(s)); };
+    std::cout << "-- Default grid (" << default_states.size() << " states)" << std::endl;
+    report_hash("legacy", default_states, LegacyStateHash{});
+    report_hash("packed", default_states, packed);
+    std::cout << "-- 128-division key space (" << fine_states.size() << " sampled states)" << std::endl;
+    report_hash("legacy", fine_states, LegacyStateHash{});
+    report_hash("packed", fine_states, packed);
+
+    // Lookup cost in std::unordered_map, the structure QLearningAgent used with State keys
+    std::unordered_map<State, std::array<double, NUM_ACTIONS>, LegacyStateHash> legacy_map;
+    std::unordered_map<StateKey, std::array<double, NUM_ACTIONS>, StateKeyHash> packed_map;
+    for (const State& s : default_states) {
+        legacy_map[s] = {1.0, 0.0, 0.0};
+        packed_map[encode_state(s)] = {1.0, 0.0, 0.0};
+    }
+    std::vector<State> order = default_states;
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+    double legacy_ns = time_lookups(legacy_map, order, [](const State& s) { return s; }, 20);
+    double packed_ns = time_lookups(packed_map, order, [](const State& s) { return encode_state(s); }, 20);
+    std::cout << "-- unordered_map lookup (including encode): legacy=" << std::setprecision(1) << legacy_ns
+              << " ns, packed=" << packed_ns << " ns" << std::endl;
+    std::cout << "-- node payload: legacy=" << sizeof(std::pair<const State, std::array<double, NUM_ACTIONS>>)
+              << " bytes, packed=" << sizeof(std::pair<const StateKey, std::array<double, NUM_ACTIONS>>)
+              << " bytes" << std::endl;
+}
+
+// Seconds elapsed since `start`
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Insert/lookup/update cost of QTable vs std::unordered_map over one set of states
+static bool compare_tables(const std::string& name, const std::vector<State>& states) {
+    std::vector<StateKey> keys(states.size());
+    for (size_t i = 0; i < states.size(); ++i) keys[i] = encode_state(states[i]);
+    std::vector<StateKey> order = keys;
+    std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+    std::unordered_map<StateKey, QValues, StateKeyHash> map;
+    QTable<QValues> table;
+
+    // Insertion (growing from empty)
+    auto start = std::chrono::steady_clock::now();
+    for (StateKey key : keys) map[key] = {static_cast<double>(key), 0.0, 0.0};
+    double map_insert = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    for (StateKey key : keys) table.find_or_insert(key) = {static_cast<double>(key), 0.0, 0.0};
+    double table_insert = seconds_since(start);
+
+    // Verify every key maps to the same row, and that absent keys are not found
+    bool ok = (table.size() == map.size());
+    for (StateKey key : keys) {
+        const QValues* row = table.find(key);
+        ok = ok && row && (*row)[0] == static_cast<double>(key);
+    }
+    std::vector<State> absent = sample_states(1000, 99);
+    for (const State& s : absent) {
+        StateKey key = encode_state(s);
+        ok = ok && ((table.find(key) != nullptr) == (map.count(key) != 0));
+    }
+
+    // Random-order lookups
+    double checksum = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (StateKey key : order) checksum += map.find(key)->second[0];
+    double map_find = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    for (StateKey key : order) checksum -= (*table.find(key))[0];
+    double table_find = seconds_since(start);
+
+    // The update_q_value access pattern: two find-or-insert probes per update
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i + 1 < order.size(); ++i) {
+        double next = map[order[i + 1]][0];
+        map[order[i]][1] += 0.1 * (next - map[order[i]][1]);
+    }
+    double map_update = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i + 1 < order.size(); ++i) {
+        double next = table.find_or_insert(order[i + 1])[0];
+        QValues& row = table.find_or_insert(order[i]);
+        row[1] += 0.1 * (next - row[1]);
+    }
+    double table_update = seconds_since(start);
+    bench_sink = bench_sink + checksum;
+
+    // Memory: unordered_map nodes hold a next pointer, the cached hash and the payload,
+    // plus roughly 16 bytes of allocator overhead each, and one pointer per bucket.
+    size_t node_bytes = sizeof(void*) + sizeof(size_t) + sizeof(std::pair<const StateKey, QValues>) + 16;
+    size_t map_bytes = map.size() * node_bytes + map.bucket_count() * sizeof(void*);
+
+    double n = static_cast<double>(states.size());
+    std::cout << "-- " << name << " (" << states.size() << " states)" << (ok ? "" : "  VERIFY FAILED") << std::endl;
+    std::cout << std::setprecision(1)
+              << "   insert ns/op: map=" << map_insert * 1e9 / n << " qtable=" << table_insert * 1e9 / n << std::endl
+              << "   find   ns/op: map=" << map_find * 1e9 / n << " qtable=" << table_find * 1e9 / n << std::endl
+              << "   update ns/op: map=" << map_update * 1e9 / n << " qtable=" << table_update * 1e9 / n << std::endl
+              << "   memory: map~" << map_bytes / 1024 << " KiB, qtable=" << table.memory_bytes() / 1024 << " KiB"
+              << " (capacity " << table.capacity() << ", avg probe " << std::setprecision(2)
+              << table.average_probe_length() << ", max probe " << table.max_probe_length() << ")" << std::endl;
+    return ok;
+}
+
+static bool analyze_tables() {
+    std::cout << "=== QTable vs std::unordered_map ===" << std::endl;
+    bool ok = compare_tables("Default grid", enumerate_states(GRID_X_DIVISIONS, GRID_Y_DIVISIONS, PADDLE_Y_DIVISIONS));
+    ok = compare_tables("128-division key space", sample_states(1 << 20, 4321)) && ok;
+    return ok;
+}
+
+// Per-call latency distribution of one growth run
+struct LatencyReport {
+    double mean_ns = 0.0;
+    double p999_ns = 0.0;
+    double max_ns = 0.0;
+};
+
+static LatencyReport summarize(std::vector<double>& samples) {
+    LatencyReport report;
+    double total = 0.0;
+    for (double ns : samples) total += ns;
+    report.mean_ns = total / samples.size();
+    std::sort(samples.begin(), samples.end());
+    report.p999_ns = samples[static_cast<size_t>(samples.size() * 0.999)];
+    report.max_ns = samples.back();
+    return report;
+}
+
+// Times every single update-style call (read the next state's row, write the current one)
+// while a table grows from empty to `keys.size()` states.
+template <typename UpdateFn>
+static LatencyReport time_growth(const std::vector<StateKey>& keys, UpdateFn update) {
+    std::vector<double> samples(keys.size() - 1);
+    for (size_t i = 0; i + 1 < keys.size(); ++i) {
+        auto start = std::chrono::steady_clock::now();
+        update(keys[i], keys[i + 1]);
+        samples[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    return summarize(samples);
+}
+
+static void print_latency(const std::string& name, const LatencyReport& report) {
+    std::cout << "   " << std::left << std::setw(22) << name << std::right << std::setprecision(0)
+              << " mean=" << std::setw(6) << report.mean_ns << " ns"
+              << "  p99.9=" << std::setw(7) << report.p999_ns << " ns"
+              << "  max=" << std::setw(10) << report.max_ns << " ns" << std::endl;
+}
+
+// Worst-case per-update latency while the Q-table grows, which is what shows up as frame hitches
+static bool analyze_growth_latency() {
+    std::cout << "=== Per-update latency during growth ===" << std::endl;
+    std::vector<State> states = sample_states(1 << 21, 2468);
+    std::vector<StateKey> keys(states.size());
+    for (size_t i = 0; i < states.size(); ++i) keys[i] = encode_state(states[i]);
+
+    std::unordered_map<StateKey, QValues, StateKeyHash> map;
+    LatencyReport map_report = time_growth(keys, [&map](StateKey key, StateKey next_key) {
+        double next = map[next_key][0];
+        map[key][0] += 0.1 * (next - map[key][0]);
+    });
+
+    QTable<QValues> incremental;
+    LatencyReport incremental_report = time_growth(keys, [&incremental](StateKey key, StateKey next_key) {
+        double next = incremental.find_or_insert(next_key)[0];
+        QValues& row = incremental.find_or_insert(key);
+        row[0] += 0.1 * (next - row[0]);
+    });
+
+    QTable<QValues> reserved;
+    reserved.reserve(keys.size());
+    LatencyReport reserved_report = time_growth(keys, [&reserved](StateKey key, StateKey next_key) {
+        double next = reserved.find_or_insert(next_key)[0];
+        QValues& row = reserved.find_or_insert(key);
+        row[0] += 0.1 * (next - row[0]);
+    });
+
+    std::cout << "-- " << keys.size() << " new states, one update per call" << std::endl;
+    print_latency("unordered_map", map_report);
+    print_latency("QTable (incremental)", incremental_report);
+    print_latency("QTable (reserved)", reserved_report);
+
+    // Check that growth lost nothing: lookups must agree with the reference map,
+    // both mid-migration and once growth has finished
+    QTable<QValues> checked;
+    bool ok = true;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        checked.find_or_insert(keys[i])[0] = static_cast<double>(i);
+        if (checked.is_growing()) {
+            size_t probe_index = (i * 7919) % (i + 1);
+            const QValues* row = checked.find(keys[probe_index]);
+            ok = ok && row && (*row)[0] == static_cast<double>(probe_index);
+        }
+    }
+    size_t visited = 0;
+    checked.for_each([&](StateKey, const QValues&) { visited++; });
+    ok = ok && visited == keys.size() && checked.size() == keys.size();
+    if (!ok) {
+        std::cout << "   VERIFY FAILED" << std::endl;
+    }
+    return ok;
+}
+
+// Tabular Q-learner over one storage format, mirroring QLearningAgent::update_q_value
+template <typename T>
+struct PrecisionLearner {
+    typedef QValueCodec<T> Codec;
+    QTable<std::array<T, NUM_ACTIONS>> table;
+    double scale = DEFAULT_Q_VALUE_BOUND / 32767.0;
+    std::mt19937 rng{11};
+    std::uniform_real_distribution<double> dither{0.0, 1.0};
+
+    QValues values(StateKey key) const {
+        QValues q{0.0, 0.0, 0.0};
+        if (const std::array<T, NUM_ACTIONS>* row = table.find(key)) {
+            for (int i = 0; i < NUM_ACTIONS; ++i) q[i] = Codec::decode((*row)[i], scale);
+        }
+        return q;
+    }
+
+    void update(StateKey key, int action, double reward, StateKey next_key, double alpha, double gamma) {
+        QValues next = values(next_key);
+        table.find_or_insert(next_key);
+        double max_future = std::max(next[0], std::max(next[1], next[2]));
+        std::array<T, NUM_ACTIONS>& row = table.find_or_insert(key);
+        double q = Codec::decode(row[action], scale);
+        double d = Codec::stochastic ? dither(rng) : 0.5;
+        row[action] = Codec::encode(q + alpha * (reward + gamma * max_future - q), scale, d);
+    }
+};
+
+// A fixed synthetic environment over the default state space: deterministic next state and
+// a sparse reward resembling the game's (+10 hit, -20 conceded, -5 wasted move)
+struct SyntheticTransition {
+    StateKey key;
+    int action;
+    double reward;
+    StateKey next_key;
+};
+
+static std::vector<SyntheticTransition> synthetic_transitions(const std::vector<StateKey>& keys, size_t count) {
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+    std::uniform_int_distribution<int> action(0, NUM_ACTIONS - 1);
+    std::vector<SyntheticTransition> transitions(count);
+    for (SyntheticTransition& t : transitions) {
+        size_t index = pick(rng);
+        t.key = keys[index];
+        t.action = action(rng);
+        size_t mixed = StateKeyHash{}(t.key * 3u + static_cast<StateKey>(t.action));
+        t.next_key = keys[mixed % keys.size()];
+        int roll = static_cast<int>((mixed >> 8) % 100);
+        t.reward = roll < 3 ? 10.0 : (roll < 5 ? -20.0 : (roll < 15 ? -5.0 : 0.0));
+    }
+    return transitions;
+}
+
+// Train one storage format on the shared stream and compare its greedy policy with double's
+template <typename T>
+static void report_precision(const std::string& name, const std::vector<StateKey>& keys,
+                             const std::vector<SyntheticTransition>& transitions,
+                             const PrecisionLearner<double>& reference) {
+    PrecisionLearner<T> learner;
+    learner.table.reserve(keys.size());
+    for (const SyntheticTransition& t : transitions) {
+        learner.update(t.key, t.action, t.reward, t.next_key, 0.1, 0.95);
+    }
+
+    size_t agree = 0;
+    size_t decisive = 0;        // States where double's best action leads by more than 0.1
+    size_t decisive_agree = 0;
+    double total_error = 0.0;
+    double max_error = 0.0;
+    for (StateKey key : keys) {
+        QValues expected = reference.values(key);
+        QValues actual = learner.values(key);
+        auto best_expected = std::max_element(expected.begin(), expected.end()) - expected.begin();
+        auto best_actual = std::max_element(actual.begin(), actual.end()) - actual.begin();
+        agree += (best_expected == best_actual);
+        QValues sorted = expected;
+        std::sort(sorted.begin(), sorted.end());
+        if (sorted[NUM_ACTIONS - 1] - sorted[NUM_ACTIONS - 2] > 0.1) {
+            decisive++;
+            decisive_agree += (best_expected == best_actual);
+        }
+        for (int i = 0; i < NUM_ACTIONS; ++i) {
+            double error = std::fabs(expected[i] - actual[i]);
+            total_error += error;
+            max_error = std::max(max_error, error);
+        }
+    }
+    std::cout << "   " << std::left << std::setw(9) << name << std::right
+              << " row=" << std::setw(2) << sizeof(std::array<T, NUM_ACTIONS>) << " B"
+              << "  table=" << std::setw(5) << learner.table.memory_bytes() / 1024 << " KiB"
+              << "  policy agreement=" << std::setprecision(2) << 100.0 * agree / keys.size() << "%"
+              << " (" << 100.0 * decisive_agree / std::max<size_t>(decisive, 1) << "% where gap>0.1)"
+              << "  mean |dQ|=" << std::setprecision(4) << total_error / (keys.size() * NUM_ACTIONS)
+              << "  max |dQ|=" << max_error << std::endl;
+}
+
+static bool analyze_precision() {
+    std::cout << "=== Q-value storage precision (vs double) ===" << std::endl;
+
+    // Codec sanity: exactly representable values survive a round trip
+    bool ok = true;
+    for (double v : {0.0, 1.5, -20.0, 10.0, 0.25, -123.5}) {
+        ok = ok && QValueCodec<Half>::decode(QValueCodec<Half>::encode(v, 1.0, 0.5), 1.0) == v;
+        ok = ok && QValueCodec<BFloat16>::decode(QValueCodec<BFloat16>::encode(v, 1.0, 0.5), 1.0) == v;
+        ok = ok && QValueCodec<Fixed16>::decode(QValueCodec<Fixed16>::encode(v, 0.25, 0.5), 0.25) == v;
+    }
+
+    std::vector<State> states = enumerate_states(GRID_X_DIVISIONS, GRID_Y_DIVISIONS, PADDLE_Y_DIVISIONS);
+    std::vector<StateKey> keys(states.size());
+    for (size_t i = 0; i < states.size(); ++i) keys[i] = encode_state(states[i]);
+    std::vector<SyntheticTransition> transitions = synthetic_transitions(keys, 20 * keys.size());
+
+    PrecisionLearner<double> reference;
+    reference.table.reserve(keys.size());
+    for (const SyntheticTransition& t : transitions) {
+        reference.update(t.key, t.action, t.reward, t.next_key, 0.1, 0.95);
+    }
+
+    std::cout << "-- " << transitions.size() << " updates over " << keys.size()
+              << " states (alpha=0.1, gamma=0.95)" << std::endl;
+    report_precision<double>("double", keys, transitions, reference);
+    report_precision<float>("float", keys, transitions, reference);
+    report_precision<Half>("Half", keys, transitions, reference);
+    report_precision<BFloat16>("BFloat16", keys, transitions, reference);
+    report_precision<Fixed16>("Fixed16", keys, transitions, reference);
+    if (!ok) {
+        std::cout << "   VERIFY FAILED (codec round trip)" << std::endl;
+    }
+    return ok;
+}
+
+// Game-like stream of states: the discretized state persists for several ticks before moving on
+static std::vector<State> persistent_trajectory(const std::vector<State>& states, size_t ticks,
+                                                double change_probability, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::uniform_int_distribution<size_t> pick(0, states.size() - 1);
+    std::vector<State> trajectory(ticks);
+    size_t current = pick(rng);
+    for (size_t i = 0; i < ticks; ++i) {
+        if (chance(rng) < change_probability) current = pick(rng);
+        trajectory[i] = states[current];
+    }
+    return trajectory;
+}
+
+static bool analyze_action_cache() {
+    std::cout << "=== Action cache ===" << std::endl;
+    std::vector<State> states = enumerate_states(GRID_X_DIVISIONS, GRID_Y_DIVISIONS, PADDLE_Y_DIVISIONS);
+    // Only a few hundred states visited, each for about 8 ticks
+    states.resize(500);
+    std::vector<State> trajectory = persistent_trajectory(states, 2000000, 0.125, 11);
+
+    // Learning: cached and uncached agents with the same seed must make identical choices.
+    // Per-tick updates rewrite the current state's row every tick (so the cache can't hit);
+    // semi-MDP updates only touch it when the state changes.
+    QLearningAgent cached(5u);
+    QLearningAgent uncached(5u);
+    uncached.set_action_cache_enabled(false);
+    size_t mismatches = 0;
+    for (int semi_mdp = 0; semi_mdp <= 1; ++semi_mdp) {
+        SemiMdpAccumulator cached_transition, uncached_transition;
+        cached.reset_action_cache_stats();
+        for (size_t i = 0; i + 1 < trajectory.size(); ++i) {
+            Action a = cached.choose_action(trajectory[i]);
+            Action b = uncached.choose_action(trajectory[i]);
+            mismatches += (a != b);
+            double reward = (static_cast<int>(a) == (trajectory[i].ball_y_grid % NUM_ACTIONS)) ? 1.0 : -0.1;
+            if (semi_mdp) {
+                cached_transition.observe(cached, trajectory[i], a, reward, trajectory[i + 1], 1.0 / 60.0);
+                uncached_transition.observe(uncached, trajectory[i], b, reward, trajectory[i + 1], 1.0 / 60.0);
+            } else {
+                cached.update_q_value(trajectory[i], a, reward, trajectory[i + 1]);
+                uncached.update_q_value(trajectory[i], b, reward, trajectory[i + 1]);
+            }
+        }
+        long hits = cached.get_action_cache_hits();
+        long misses = cached.get_action_cache_misses();
+        std::cout << "-- learning " << (semi_mdp ? "(semi-MDP) " : "(per tick) ") << trajectory.size()
+                  << " ticks, state changes every ~8: hit rate " << std::fixed << std::setprecision(1)
+                  << 100.0 * hits / std::max(1L, hits + misses) << "%" << std::defaultfloat << std::endl;
+    }
+
+    // A coarse level: a state whose own row is still unlearned decides from its coarse cell as
+    // soon as the cell learns, even when another state taught it. The table starts with a zero
+    // row for every state (like the next-state placeholders a flat table saves); each state
+    // decides, a neighbour in its level-1 cell learns that DOWN pays, and the state decides again.
+    {
+        QLearningAgent coarse_cached(5u);
+        QLearningAgent coarse_uncached(5u);
+        coarse_uncached.set_action_cache_enabled(false);
+        for (QLearningAgent* agent : {&coarse_cached, &coarse_uncached}) {
+            agent->set_parameters(agent->get_alpha(), agent->get_gamma(), 0.0); // Greedy decisions only
+            for (const State& s : states) agent->set_q_values(encode_state(s), QValues{0.0, 0.0, 0.0});
+            agent->set_coarse_levels(1);
+        }
+        for (const State& s : states) {
+            State neighbour = s;
+            neighbour.cpu_paddle_y_grid ^= 1; // Same level-1 cell (every axis is halved)
+            for (int ask = 0; ask < 2; ++ask) {
+                Action a = coarse_cached.choose_action(s);
+                Action b = coarse_uncached.choose_action(s);
+                mismatches += (a != b);
+                if (ask == 0) {
+                    coarse_cached.update_q_value(neighbour, Action::DOWN, 1.0, neighbour);
+                    coarse_uncached.update_q_value(neighbour, Action::DOWN, 1.0, neighbour);
+                }
+            }
+        }
+        std::cout << "-- learning (1 coarse level, cells taught by neighbours) " << states.size()
+                  << " states" << std::endl;
+    }
+    std::cout << "-- decisions differing from uncached: " << mismatches << std::endl;
+
+    // Playing without learning (the table no longer changes): time choose_action alone
+    cached.reset_action_cache_stats();
+    auto time_choices = [&trajectory](QLearningAgent& agent) {
+        auto start = std::chrono::steady_clock::now();
+        long checksum = 0;
+        for (const State& s : trajectory) checksum += static_cast<long>(agent.choose_action(s));
+        double seconds = seconds_since(start);
+        return std::make_pair(seconds, checksum);
+    };
+    std::pair<double, long> with_cache = time_choices(cached);
+    std::pair<double, long> without_cache = time_choices(uncached);
+    long hits = cached.get_action_cache_hits();
+    long misses = cached.get_action_cache_misses();
+    std::cout << "-- playing: hit rate " << std::fixed << std::setprecision(1) << 100.0 * hits / std::max(1L, hits + misses) << "%, choose_action "
+              << std::setprecision(1) << 1e9 * with_cache.first / trajectory.size() << " ns cached vs "
+              << 1e9 * without_cache.first / trajectory.size() << " ns uncached" << std::defaultfloat << std::endl;
+
+    bool ok = (mismatches == 0 && with_cache.second == without_cache.second);
+    if (!ok) {
+        std::cout << "   VERIFY FAILED (cached decisions differ)" << std::endl;
+    }
+    return ok;
+}
+
+// Random observations with the ranges make_observation produces
+static std::vector<Observation> sample_observations(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+    std::vector<Observation> observations(count);
+    for (Observation& o : observations) {
+        o.ball_x = unit(rng);
+        o.ball_y = unit(rng);
+        o.ball_vx = direction(rng);
+        o.ball_vy = direction(rng);
+        o.cpu_paddle_y = unit(rng);
+        o.player_paddle_y = unit(rng);
+        o.ball_intercept_y = unit(rng);
+    }
+    return observations;
+}
+
+static bool analyze_dqn() {
+    std::cout << "=== Neural network agent ===" << std::endl;
+    const size_t count = 4096; // e.g. one decision for each of thousands of environments
+    const int rounds = 50;
+    std::vector<Observation> observations = sample_observations(count, 21);
+    DqnAgent agent(3u);
+    std::cout << "-- " << agent.get_parameter_count() << " parameters, networks + optimizer "
+              << agent.memory_bytes() / 1024 << " KB" << std::endl;
+
+    // Batched vs one observation at a time: same greedy actions
+    std::vector<Action> batched(count), single(count);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) agent.best_actions(observations.data(), count, batched.data());
+    double batched_seconds = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < count; ++i) single[i] = agent.best_action(observations[i]);
+    }
+    double single_seconds = seconds_since(start);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; ++i) mismatches += (batched[i] != single[i]);
+
+    // Epsilon-greedy: the batched call must consume random numbers like sequential calls
+    DqnAgent batched_agent(3u), single_agent(3u);
+    batched_agent.set_parameters(0.001, 0.9, 0.3);
+    single_agent.set_parameters(0.001, 0.9, 0.3);
+    batched_agent.choose_actions(observations.data(), count, batched.data());
+    for (size_t i = 0; i < count; ++i) single[i] = single_agent.choose_action(observations[i]);
+    for (size_t i = 0; i < count; ++i) mismatches += (batched[i] != single[i]);
+
+    // The Q-table's batched lookup on the same number of states, for scale
+    std::vector<State> states = sample_states(count, 21);
+    QLearningAgent table_agent(3u);
+    table_agent.set_parameters(0.1, 0.9, 0.0);
+    std::vector<Action> table_actions(count);
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) table_agent.choose_actions(states.data(), count, table_actions.data());
+    double table_seconds = seconds_since(start);
+
+    double per_state = 1e9 / (static_cast<double>(count) * rounds);
+    std::cout << std::fixed << std::setprecision(1)
+              << "-- inference, " << count << " observations: batched " << batched_seconds * per_state
+              << " ns/obs, one at a time " << single_seconds * per_state << " ns/obs (Q-table batched "
+              << table_seconds * per_state << " ns/state)" << std::endl;
+
+    // Training: every DQN_TRAIN_INTERVAL stored transitions cost one minibatch step
+    const size_t transitions = 200000;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i + 1 < transitions; ++i) {
+        const Observation& o = observations[i % count];
+        Action a = static_cast<Action>(i % NUM_ACTIONS);
+        agent.update_q_value(o, a, o.ball_y > o.cpu_paddle_y ? 0.1 : -0.1, observations[(i + 1) % count]);
+    }
+    double train_seconds = seconds_since(start);
+    std::cout << "-- training: " << agent.get_update_count() << " minibatch steps of " << DQN_MINIBATCH
+              << ", " << 1e6 * train_seconds / std::max(1L, agent.get_update_count()) << " us per step, "
+              << 1e9 * train_seconds / transitions << " ns per stored transition" << std::defaultfloat << std::endl;
+    std::cout << "-- batched decisions differing from sequential: " << mismatches << std::endl;
+
+    bool ok = (mismatches == 0);
+    if (!ok) {
+        std::cout << "   VERIFY FAILED (batched decisions differ)" << std::endl;
+    }
+    return ok;
+}
+
+// --- Discretization ---
+
+// Continuous inputs of one discretize call (pixels, pixels per second)
+struct RawState {
+    float ball_x, ball_y, ball_vx, ball_vy, cpu_y, player_y;
+};
+
+// The game's field
+static const float BENCH_FIELD_WIDTH = static_cast<float>(WINDOW_WIDTH);
+static const float BENCH_FIELD_HEIGHT = static_cast<float>(WINDOW_HEIGHT);
+
+static std::string grid_name_of(const Discretization& grid) {
+    return std::to_string(grid.grid_x) + "x" + std::to_string(grid.grid_y) + "x" + std::to_string(grid.paddle_y);
+}
+
+// Positions over the field and a little beyond its edges, plus exact cell boundaries
+static std::vector<RawState> sample_raw_states(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> x(-20.0f, BENCH_FIELD_WIDTH + 20.0f);
+    std::uniform_real_distribution<float> y(-20.0f, BENCH_FIELD_HEIGHT + 20.0f);
+    std::uniform_real_distribution<float> v(-400.0f, 400.0f);
+    std::vector<RawState> samples(count);
+    for (size_t i = 0; i < count; ++i) {
+        RawState& r = samples[i];
+        if (i % 8 == 0) {
+            // Whole pixels: every boundary of the 10-, 20- and 40-division grids is one
+            r = {std::floor(x(rng)), std::floor(y(rng)), v(rng), 0.0f, std::floor(y(rng)), std::floor(y(rng))};
+        } else {
+            r = {x(rng), y(rng), v(rng), v(rng), y(rng), y(rng)};
+        }
+    }
+    return samples;
+}
+
+// The discretization before Discretizer: a division by the cell size and a floor per axis
+static State legacy_discretize(const RawState& r, const Discretization& grid) {
+    auto axis = [](float value, float extent, int divisions) {
+        int cell = static_cast<int>(std::floor(value / (extent / static_cast<float>(divisions))));
+        return std::max(0, std::min(divisions - 1, cell));
+    };
+    State s;
+    s.ball_x_grid = axis(r.ball_x, BENCH_FIELD_WIDTH, grid.grid_x);
+    s.ball_y_grid = axis(r.ball_y, BENCH_FIELD_HEIGHT, grid.grid_y);
+    s.ball_vx_category = (r.ball_vx > 0) ? 1 : ((r.ball_vx < 0) ? -1 : 0);
+    s.ball_vy_category = (r.ball_vy > 0) ? 1 : ((r.ball_vy < 0) ? -1 : 0);
+    s.cpu_paddle_y_grid = axis(r.cpu_y, BENCH_FIELD_HEIGHT, grid.paddle_y);
+    s.player_paddle_y_grid = axis(r.player_y, BENCH_FIELD_HEIGHT, grid.paddle_y);
+    return s;
+}
+
+// Times one resolution on a cache-resident set of inputs: compile-time Discretizer vs runtime
+// discretize_state vs the legacy division. Then checks on all samples that the two current
+// paths agree exactly.
+template <typename D>
+static bool report_discretizer(const std::vector<RawState>& samples) {
+    const Discretization grid = Discretization::of<D>();
+    auto fixed_key = [](const RawState& r) {
+        return encode_state(D::discretize(r.ball_x, r.ball_y, r.ball_vx, r.ball_vy, r.cpu_y, r.player_y));
+    };
+    auto runtime_key = [&grid](const RawState& r) {
+        return encode_state(discretize_state(r.ball_x, r.ball_y, r.ball_vx, r.ball_vy, r.cpu_y, r.player_y,
+                                             BENCH_FIELD_WIDTH, BENCH_FIELD_HEIGHT, grid));
+    };
+    auto legacy_key = [&grid](const RawState& r) { return encode_state(legacy_discretize(r, grid)); };
+
+    const size_t hot = 4096; // 96 KB of inputs: measures the arithmetic, not memory bandwidth
+    const int rounds = 2000;
+    auto time_calls = [&samples, hot, rounds](auto key) {
+        std::vector<StateKey> keys(hot);
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            for (size_t i = 0; i < hot; ++i) keys[i] = key(samples[i]);
+        }
+        double seconds = seconds_since(start);
+        bench_sink = bench_sink + keys[hot / 2];
+        return 1e9 * seconds / (static_cast<double>(hot) * rounds);
+    };
+    double fixed_ns = time_calls(fixed_key);
+    double runtime_ns = time_calls(runtime_key);
+    double legacy_ns = time_calls(legacy_key);
+
+    size_t mismatches = 0;
+    size_t legacy_differences = 0;
+    for (const RawState& r : samples) {
+        StateKey key = fixed_key(r);
+        mismatches += (key != runtime_key(r));
+        legacy_differences += (key != legacy_key(r));
+    }
+    std::cout << "   " << std::left << std::setw(10) << grid_name_of(grid) << std::right << std::fixed << std::setprecision(2)
+              << " states " << std::setw(9) << D::state_space_size
+              << "  Discretizer " << fixed_ns << " ns, runtime " << runtime_ns
+              << " ns, legacy division " << legacy_ns << " ns"
+              << "  | differs from runtime: " << mismatches << ", from legacy: " << legacy_differences
+              << std::defaultfloat << std::endl;
+    return mismatches == 0;
+}
+
+static bool analyze_discretization() {
+    std::cout << "=== Discretization ===" << std::endl;
+    std::vector<RawState> samples = sample_raw_states(1 << 20, 17);
+    std::cout << "-- " << samples.size() << " positions (1/8 on whole pixels), " << WINDOW_WIDTH << "x"
+              << WINDOW_HEIGHT << " field, per call:" << std::endl;
+    bool ok = report_discretizer<Discretizer<5, 5, 5>>(samples);
+    ok = report_discretizer<DefaultDiscretizer>(samples) && ok;
+    ok = report_discretizer<Discretizer<20, 20, 20>>(samples) && ok;
+    ok = report_discretizer<Discretizer<40, 40, 40>>(samples) && ok;
+    if (!ok) {
+        std::cout << "   VERIFY FAILED (Discretizer differs from discretize_state)" << std::endl;
+    }
+    return ok;
+}
+
+int main() {
+    analyze_hashes();
+    bool ok = analyze_tables();
+    ok = analyze_growth_latency() && ok;
+    ok = analyze_precision() && ok;
+    ok = analyze_action_cache() && ok;
+    ok = analyze_dqn() && ok;
+    ok = analyze_discretization() && ok;
+    return ok ? 0 : 1;
+}
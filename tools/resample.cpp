@@ -0,0 +1,105 @@
+// Carries a saved Q-table over to another grid resolution (see Resampling.h), so training at the
+// new resolution can start from it (e.g. Sweep --load) instead of from an empty table.
+//
+// Usage: Resample input output --to XxYxP [--from XxYxP]
+//   input             Q-table saved by the game or the training tools
+//   output            where to save the resampled table
+//   --to GRID         grid to resample to: ball x, ball y and paddle divisions
+//   --from GRID       grid the input was learned on (default: the game's, 10x10x10)
+#include "Resampling.h"
+#include "QLearningAgent.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+static void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " input output --to XxYxP [--from XxYxP]" << std::endl;
+}
+
+// Parses "10x10x10"; returns false on malformed or out-of-range sizes.
+static bool parse_grid(const std::string& text, Discretization& grid) {
+    char x1 = 0, x2 = 0;
+    std::istringstream fields(text);
+    return (fields >> grid.grid_x >> x1 >> grid.grid_y >> x2 >> grid.paddle_y) && x1 == 'x' && x2 == 'x' &&
+           fields.eof() && grid.is_valid();
+}
+
+static std::string grid_name(const Discretization& grid) {
+    return std::to_string(grid.grid_x) + "x" + std::to_string(grid.grid_y) + "x" + std::to_string(grid.paddle_y);
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    std::string input_path;
+    std::string output_path;
+    Discretization from;
+    Discretization to;
+    bool have_to = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            if (input_path.empty()) input_path = arg;
+            else if (output_path.empty()) output_path = arg;
+            else {
+                print_usage(argv[0]);
+                return 1;
+            }
+            continue;
+        }
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool ok = true;
+        if (arg == "--from") ok = parse_grid(value, from);
+        else if (arg == "--to") ok = have_to = parse_grid(value, to);
+        else ok = false;
+        if (!ok) {
+            std::cerr << "Error: Invalid argument: " << arg << " " << value << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (input_path.empty() || output_path.empty() || !have_to) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    QLearningAgent source(1);
+    auto start = std::chrono::steady_clock::now();
+    if (!source.load_q_table(input_path)) {
+        return 1; // The load already reported the error
+    }
+    double load_seconds = seconds_since(start);
+
+    QLearningAgent target(1);
+    ResamplingStats stats;
+    start = std::chrono::steady_clock::now();
+    if (!resample_q_table(source, from, to, target, &stats)) {
+        return 1;
+    }
+    double resample_seconds = seconds_since(start);
+    if (stats.skipped_states > 0) {
+        std::cerr << "Warning: " << stats.skipped_states << " states lie outside the " << grid_name(from)
+                  << " grid (was the table learned on another grid? see --from); they were skipped." << std::endl;
+    }
+
+    start = std::chrono::steady_clock::now();
+    if (!target.save_q_table(output_path)) {
+        return 1;
+    }
+    double save_seconds = seconds_since(start);
+
+    std::cout << std::fixed << std::setprecision(3)
+              << grid_name(from) << " -> " << grid_name(to) << ": " << stats.source_states << " states -> "
+              << stats.target_states << " states (load " << load_seconds << " s, resample " << resample_seconds
+              << " s, save " << save_seconds << " s)" << std::endl;
+    return 0;
+}
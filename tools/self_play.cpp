@@ -0,0 +1,106 @@
+// Headless self-play training: both paddles are Q-learning agents playing at full speed with
+// no window, against each other and against frozen snapshots of earlier versions.
+// The right agent's Q-table is saved in the game's format, ready to be loaded by the game
+// (copy it to pong_q_table.dat) or baked in with PONG_BAKED_Q_TABLE.
+//
+// Usage: SelfPlay [options]
+//   --steps N              physics steps to simulate (default 5000000)
+//   --separate             give the left paddle its own Q-table instead of sharing one
+//   --snapshot-interval N  steps between opponent snapshots, 0 to disable (default 200000)
+//   --max-snapshots N      snapshot pool size (default 8)
+//   --snapshot-prob P      chance a point is played against a snapshot (default 0.5)
+//   --alpha A --gamma G --epsilon E   learning parameters (default 0.1, 0.9, 0.1)
+//   --smdp                 semi-MDP learning: one update per change of discretized state
+//   --seed N               random seed (default 1)
+//   --load FILE            start from a saved Q-table
+//   --out FILE             where to save the result (default self_play_q_table.dat)
+#include "SelfPlay.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+static void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--steps N] [--separate] [--snapshot-interval N]"
+              << " [--max-snapshots N] [--snapshot-prob P] [--alpha A] [--gamma G] [--epsilon E] [--smdp]"
+              << " [--seed N] [--load FILE] [--out FILE]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    SelfPlayConfig config;
+    std::string load_path;
+    std::string out_path = "self_play_q_table.dat";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--separate") {
+            config.share_table = false;
+            continue;
+        }
+        if (arg == "--smdp") {
+            config.semi_mdp = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--steps") config.steps = std::atol(value);
+        else if (arg == "--snapshot-interval") config.snapshot_interval = std::atol(value);
+        else if (arg == "--max-snapshots") config.max_snapshots = static_cast<size_t>(std::atol(value));
+        else if (arg == "--snapshot-prob") config.snapshot_probability = std::atof(value);
+        else if (arg == "--alpha") config.alpha = std::atof(value);
+        else if (arg == "--gamma") config.gamma = std::atof(value);
+        else if (arg == "--epsilon") config.epsilon = std::atof(value);
+        else if (arg == "--seed") config.seed = static_cast<unsigned int>(std::atol(value));
+        else if (arg == "--load") load_path = value;
+        else if (arg == "--out") out_path = value;
+        else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    SelfPlayTrainer trainer(config);
+    if (!load_path.empty()) {
+        if (!trainer.get_agent().load_q_table(load_path)) {
+            return 1; // The load already reported the error
+        }
+        if (!config.share_table && !trainer.get_left_agent().load_q_table(load_path)) {
+            return 1;
+        }
+    }
+
+    std::cout << "Self-play: " << config.steps << " steps, "
+              << (config.share_table ? "shared" : "separate") << " Q-table"
+              << (config.share_table ? "" : "s") << ", snapshot every " << config.snapshot_interval
+              << " steps (pool " << config.max_snapshots << ", p=" << config.snapshot_probability << ")"
+              << std::endl;
+
+    // Train in ten chunks and report each one
+    const int reports = 10;
+    auto start = std::chrono::steady_clock::now();
+    long done = 0;
+    for (int r = 1; r <= reports; ++r) {
+        long chunk = config.steps * r / reports - done;
+        SelfPlayStats stats = trainer.run(chunk);
+        done += chunk;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double points = stats.points > 0 ? static_cast<double>(stats.points) : 1.0;
+        std::cout << std::fixed << std::setprecision(2)
+                  << "steps " << std::setw(10) << done
+                  << "  points " << std::setw(6) << stats.points
+                  << "  returns/point " << std::setw(6) << (stats.right_hits + stats.left_hits) / points
+                  << "  right lost " << std::setw(5) << 100.0 * stats.right_conceded / points << "%"
+                  << "  vs snapshots " << std::setw(5) << 100.0 * stats.snapshot_points / points << "%"
+                  << "  states " << std::setw(6) << trainer.get_agent().get_explored_state_count()
+                  << "  snapshots " << trainer.get_snapshot_count()
+                  << "  " << std::setprecision(0) << done / (seconds > 0.0 ? seconds : 1.0) << " steps/s"
+                  << std::endl;
+    }
+
+    // The save reports success or failure itself
+    return trainer.get_agent().save_q_table(out_path) ? 0 : 1;
+}
@@ -0,0 +1,361 @@
+// Hyperparameter sweep: trains one headless agent per combination of agent kind, alpha, gamma,
+// epsilon and grid size (see TrainingJob.h), all in one process on a thread pool sized to the machine, and
+// writes a results table.
+//
+// Usage: Sweep [options]
+//   --alpha LIST      learning rates (default 0.1)
+//   --gamma LIST      discount factors (default 0.9)
+//   --epsilon LIST    exploration rates (default 0.1)
+//   --lr-exponent LIST  count-based learning-rate exponents, 0 = fixed alpha (default 0)
+//   --ucb LIST        UCB exploration bonus weights, 0 = off (default 0)
+//   --smdp LIST       1 = semi-MDP updates on state changes, 0 = one update per step (default 0)
+//   --levels LIST     coarse-to-fine hierarchy depths, 0 = flat table (default 0)
+//   --refine LIST     updates of a level-1 cell before its states get their own rows, 0 = at once
+//                     (default 0; only with --levels)
+//   --mirror LIST     1 = mirrored states share one table row, 0 = separate rows (default 0)
+//   --planning LIST   Dyna-Q simulated updates per real update, 0 = none (default 0)
+//   --planning-us LIST  time limit in microseconds on the simulated updates per real update,
+//                     0 = none (default 0); alone it plans as many as fit
+//   --agent NAMES     comma-separated agents: table (tabular Q-learning), tiles (tile coding),
+//                     linear (linear features), dqn (neural network; use an alpha around
+//                     0.0003) (default table); the grid, --lr-exponent, --ucb, --smdp, --levels, --mirror and --planning only
+//                     apply to the tabular agent
+//   --grid GRIDS      comma-separated XxYxP grid sizes: ball x, ball y and paddle divisions
+//                     (default 10x10x10)
+//   --steps N         training steps per job (default 2000000)
+//   --threshold W     training win rate that counts as learned (default 0.5)
+//   --skill S         scripted opponent skill in [0, 1] (default 0.5)
+//   --threads N       worker threads (default: one per hardware thread)
+//   --replicates N    runs of every configuration, each with its own seed (default 1)
+//   --seed N          base seed; replicate r of every configuration uses seed + 7919 * r, so
+//                     configurations that differ only in a swept parameter train on the same
+//                     ball and opponent (default 1)
+//   --load FILE       start every job from this Q-table (read once)
+//   --load-grid GRID  grid the --load table was learned on; it is resampled to each job's grid
+//                     (see Resampling.h). Without it the table is used as is
+//   --out FILE        results as CSV (default sweep_results.csv)
+// A LIST is either comma-separated values ("0.05,0.1,0.2") or an evenly spaced range
+// "first:last:count" ("0.05:0.25:5").
+#include "TrainingJob.h"
+#include "Resampling.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--alpha LIST] [--gamma LIST] [--epsilon LIST] [--lr-exponent LIST] [--ucb LIST]"
+              << " [--smdp 0,1] [--levels LIST] [--refine LIST] [--mirror 0,1] [--planning LIST] [--planning-us LIST] [--agent table,tiles,linear,dqn] [--grid XxYxP,...]"
+              << " [--steps N] [--threshold W] [--skill S] [--threads N] [--replicates N] [--seed N] [--load FILE] [--load-grid XxYxP] [--out FILE]"
+              << std::endl;
+}
+
+// Parses "a,b,c" or "first:last:count"; returns false on malformed input.
+static bool parse_values(const std::string& text, std::vector<double>& values) {
+    values.clear();
+    if (text.find(':') != std::string::npos) {
+        double first = 0.0, last = 0.0;
+        int count = 0;
+        char colon1 = 0, colon2 = 0;
+        std::istringstream in(text);
+        if (!(in >> first >> colon1 >> last >> colon2 >> count) || colon1 != ':' || colon2 != ':' || count < 1) {
+            return false;
+        }
+        for (int i = 0; i < count; ++i) {
+            values.push_back(count == 1 ? first : first + (last - first) * i / (count - 1));
+        }
+        return true;
+    }
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        char* end = nullptr;
+        double value = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0') return false;
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+// Parses "10x10x10,16x12x12"; returns false on malformed or out-of-range sizes.
+static bool parse_grids(const std::string& text, std::vector<Discretization>& grids) {
+    grids.clear();
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        Discretization grid;
+        char x1 = 0, x2 = 0;
+        std::istringstream fields(item);
+        if (!(fields >> grid.grid_x >> x1 >> grid.grid_y >> x2 >> grid.paddle_y) || x1 != 'x' || x2 != 'x' ||
+            !grid.is_valid()) {
+            return false;
+        }
+        grids.push_back(grid);
+    }
+    return !grids.empty();
+}
+
+// Parses "table,tiles,linear,dqn"; returns false on unknown names.
+static bool parse_agents(const std::string& text, std::vector<AgentKind>& kinds) {
+    kinds.clear();
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        AgentKind kind;
+        if (!parse_agent_kind(item, kind)) return false;
+        kinds.push_back(kind);
+    }
+    return !kinds.empty();
+}
+
+static std::string grid_name(const Discretization& grid) {
+    return std::to_string(grid.grid_x) + "x" + std::to_string(grid.grid_y) + "x" + std::to_string(grid.paddle_y);
+}
+
+// "-" without Dyna-Q planning, otherwise the updates per real one and/or the time limit ("10",
+// "50us", "10/50us")
+static std::string planning_name(const TrainingConfig& c) {
+    std::ostringstream name;
+    if (c.planning_updates > 0) name << c.planning_updates;
+    if (c.planning_updates > 0 && c.planning_microseconds > 0.0) name << "/";
+    if (c.planning_microseconds > 0.0) name << c.planning_microseconds << "us";
+    return name.str().empty() ? "-" : name.str();
+}
+
+// Share of the greedy decisions the Q-table's action cache answered ("-" without any)
+static std::string cache_name(const TrainingResult& r) {
+    long decisions = r.action_cache_hits + r.action_cache_misses;
+    if (decisions == 0) return "-";
+    return std::to_string(static_cast<int>(100.0 * r.action_cache_hits / decisions + 0.5)) + "%";
+}
+
+// "-" for a flat table, otherwise the hierarchy depth (and "/refine visits" if set)
+static std::string levels_name(const TrainingConfig& c) {
+    if (c.coarse_levels == 0) return "-";
+    return std::to_string(c.coarse_levels) + (c.refine_visits > 0 ? "/" + std::to_string(c.refine_visits) : "");
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<double> alphas{0.1};
+    std::vector<double> gammas{0.9};
+    std::vector<double> epsilons{0.1};
+    std::vector<double> exponents{0.0};
+    std::vector<double> bonuses{0.0};
+    std::vector<double> semi_mdp_modes{0.0};
+    std::vector<double> level_counts{0.0};
+    std::vector<double> refine_counts{0.0};
+    std::vector<double> mirror_modes{0.0};
+    std::vector<double> planning_counts{0.0};
+    std::vector<double> planning_budgets{0.0};
+    std::vector<AgentKind> agent_kinds{AgentKind::QTable};
+    std::vector<Discretization> grids{Discretization()};
+    TrainingConfig base;
+    size_t thread_count = 0;
+    long replicates = 1;
+    std::string load_path;
+    std::vector<Discretization> load_grid; // Empty: use the loaded table as is
+    std::string out_path = "sweep_results.csv";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool ok = true;
+        if (arg == "--alpha") ok = parse_values(value, alphas);
+        else if (arg == "--gamma") ok = parse_values(value, gammas);
+        else if (arg == "--epsilon") ok = parse_values(value, epsilons);
+        else if (arg == "--lr-exponent") ok = parse_values(value, exponents);
+        else if (arg == "--ucb") ok = parse_values(value, bonuses);
+        else if (arg == "--smdp") ok = parse_values(value, semi_mdp_modes);
+        else if (arg == "--levels") ok = parse_values(value, level_counts);
+        else if (arg == "--refine") ok = parse_values(value, refine_counts);
+        else if (arg == "--mirror") ok = parse_values(value, mirror_modes);
+        else if (arg == "--planning") ok = parse_values(value, planning_counts);
+        else if (arg == "--planning-us") ok = parse_values(value, planning_budgets);
+        else if (arg == "--agent") ok = parse_agents(value, agent_kinds);
+        else if (arg == "--grid") ok = parse_grids(value, grids);
+        else if (arg == "--steps") base.steps = std::atol(value.c_str());
+        else if (arg == "--threshold") base.win_threshold = std::atof(value.c_str());
+        else if (arg == "--skill") base.opponent_skill = static_cast<float>(std::atof(value.c_str()));
+        else if (arg == "--threads") thread_count = static_cast<size_t>(std::atol(value.c_str()));
+        else if (arg == "--replicates") replicates = std::atol(value.c_str());
+        else if (arg == "--seed") base.seed = static_cast<unsigned int>(std::atol(value.c_str()));
+        else if (arg == "--load") load_path = value;
+        else if (arg == "--load-grid") ok = parse_grids(value, load_grid) && load_grid.size() == 1;
+        else if (arg == "--out") out_path = value;
+        else ok = false;
+        if (!ok) {
+            std::cerr << "Error: Invalid argument: " << arg << " " << value << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (base.steps < 1) {
+        std::cerr << "Error: --steps must be positive." << std::endl;
+        return 1;
+    }
+    if (replicates < 1) {
+        std::cerr << "Error: --replicates must be positive." << std::endl;
+        return 1;
+    }
+    if (base.window_steps > base.steps) {
+        base.window_steps = base.steps;
+    }
+
+    // Every job starts as a copy of this agent, so a table given with --load is parsed only once
+    QLearningAgent initial_agent(base.seed);
+    if (!load_path.empty() && !initial_agent.load_q_table(load_path)) {
+        return 1; // The load already reported the error
+    }
+
+    // One starting agent per grid: the loaded table, resampled to that grid if it was learned on another
+    std::vector<QLearningAgent> grid_agents;
+    for (const Discretization& grid : grids) {
+        bool resample = !load_path.empty() && !load_grid.empty() &&
+                        (grid.grid_x != load_grid[0].grid_x || grid.grid_y != load_grid[0].grid_y ||
+                         grid.paddle_y != load_grid[0].paddle_y);
+        if (!resample) {
+            grid_agents.push_back(initial_agent);
+            continue;
+        }
+        QLearningAgent resampled(base.seed);
+        ResamplingStats stats;
+        if (!resample_q_table(initial_agent, load_grid[0], grid, resampled, &stats)) {
+            return 1;
+        }
+        std::cout << "Resampled " << load_path << " from " << grid_name(load_grid[0]) << " to " << grid_name(grid)
+                  << ": " << stats.source_states << " -> " << stats.target_states << " states" << std::endl;
+        grid_agents.push_back(resampled);
+    }
+
+    // One configuration per combination, expanding one parameter at a time
+    // (the agent kind varies slowest, the replicate fastest)
+    std::vector<TrainingConfig> configs{base};
+    auto expand = [&configs](const auto& values, auto set) {
+        std::vector<TrainingConfig> expanded;
+        for (const TrainingConfig& config : configs) {
+            for (const auto& value : values) {
+                TrainingConfig c = config;
+                set(c, value);
+                expanded.push_back(c);
+            }
+        }
+        configs.swap(expanded);
+    };
+    expand(agent_kinds, [](TrainingConfig& c, AgentKind v) { c.agent = v; });
+    expand(grids, [](TrainingConfig& c, const Discretization& v) { c.grid = v; });
+    expand(alphas, [](TrainingConfig& c, double v) { c.alpha = v; });
+    expand(gammas, [](TrainingConfig& c, double v) { c.gamma = v; });
+    expand(epsilons, [](TrainingConfig& c, double v) { c.epsilon = v; });
+    expand(exponents, [](TrainingConfig& c, double v) { c.learning_rate_exponent = v; });
+    expand(bonuses, [](TrainingConfig& c, double v) { c.exploration_bonus = v; });
+    expand(semi_mdp_modes, [](TrainingConfig& c, double v) { c.semi_mdp = (v != 0.0); });
+    expand(level_counts, [](TrainingConfig& c, double v) { c.coarse_levels = static_cast<int>(v); });
+    expand(refine_counts, [](TrainingConfig& c, double v) { c.refine_visits = static_cast<int>(v); });
+    expand(mirror_modes, [](TrainingConfig& c, double v) { c.mirror_symmetry = (v != 0.0); });
+    expand(planning_counts, [](TrainingConfig& c, double v) { c.planning_updates = static_cast<int>(v); });
+    expand(planning_budgets, [](TrainingConfig& c, double v) { c.planning_microseconds = v; });
+    // The seed depends only on the replicate, never on the configuration's place in the product
+    std::vector<unsigned int> seeds;
+    for (long r = 0; r < replicates; ++r) {
+        seeds.push_back(base.seed + static_cast<unsigned int>(r) * 7919u);
+    }
+    expand(seeds, [](TrainingConfig& c, unsigned int v) { c.seed = v; });
+
+    ThreadPool pool(thread_count);
+    std::cout << "Sweep: " << configs.size() << " configurations x " << base.steps << " steps on "
+              << pool.size() << " thread" << (pool.size() == 1 ? "" : "s") << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<TrainingResult>> pending;
+    for (const TrainingConfig& config : configs) {
+        size_t g = 0;
+        while (grids[g].grid_x != config.grid.grid_x || grids[g].grid_y != config.grid.grid_y ||
+               grids[g].paddle_y != config.grid.paddle_y) {
+            ++g;
+        }
+        const QLearningAgent& start_agent = grid_agents[g];
+        pending.push_back(pool.submit([config, &start_agent] {
+            if (config.agent != AgentKind::QTable) {
+                return run_training_job(config, *make_agent(config.agent, config.seed));
+            }
+            QLearningAgent agent(start_agent); // Read-only access to the shared initial agent
+            agent.seed(config.seed);
+            return run_training_job(config, agent);
+        }));
+    }
+
+    // Collect in configuration order
+    std::vector<TrainingResult> results;
+    std::cout << std::left << std::setw(7) << "agent" << std::setw(8) << "alpha" << std::setw(8) << "gamma" << std::setw(9) << "epsilon"
+              << std::setw(7) << "lr exp" << std::setw(6) << "ucb" << std::setw(5) << "smdp" << std::setw(7) << "levels"
+              << std::setw(7) << "mirror" << std::setw(9) << "planning"
+              << std::setw(11) << "grid" << std::right << std::setw(11) << "seed" << std::setw(9) << "win rate" << std::setw(14) << "to threshold"
+              << std::setw(9) << "states" << std::setw(9) << "MB" << std::setw(10) << "updates" << std::setw(7) << "cache" << std::setw(10) << "seconds" << std::endl;
+    for (size_t i = 0; i < configs.size(); ++i) {
+        results.push_back(pending[i].get());
+        const TrainingConfig& c = configs[i];
+        const TrainingResult& r = results.back();
+        std::cout << std::left << std::setw(7) << agent_kind_name(c.agent) << std::setw(8) << c.alpha << std::setw(8) << c.gamma << std::setw(9) << c.epsilon
+                  << std::setw(7) << c.learning_rate_exponent << std::setw(6) << c.exploration_bonus
+                  << std::setw(5) << (c.semi_mdp ? "yes" : "no") << std::setw(7) << levels_name(c)
+                  << std::setw(7) << (c.mirror_symmetry ? "yes" : "no") << std::setw(9) << planning_name(c) << std::setw(11) << grid_name(c.grid) << std::right << std::setw(11) << c.seed << std::fixed << std::setprecision(3)
+                  << std::setw(9) << r.final_win_rate << std::setw(14)
+                  << (r.steps_to_threshold >= 0 ? std::to_string(r.steps_to_threshold) : std::string("-"))
+                  << std::setw(9) << r.table_size << std::setw(9) << r.memory_bytes / 1048576.0 << std::setw(10) << r.updates << std::setw(7) << cache_name(r) << std::setprecision(2) << std::setw(10) << r.wall_seconds
+                  << std::defaultfloat << std::endl;
+    }
+    double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Best configuration by its mean win rate over the replicates (which are adjacent)
+    size_t best = 0;
+    double best_win_rate = -1.0;
+    for (size_t i = 0; i < results.size(); i += replicates) {
+        double win_rate = 0.0;
+        for (long r = 0; r < replicates; ++r) {
+            win_rate += results[i + r].final_win_rate;
+        }
+        win_rate /= replicates;
+        if (win_rate > best_win_rate) {
+            best = i;
+            best_win_rate = win_rate;
+        }
+    }
+    std::cout << "Best: agent=" << agent_kind_name(configs[best].agent) << " alpha=" << configs[best].alpha << " gamma=" << configs[best].gamma
+              << " epsilon=" << configs[best].epsilon << " lr-exponent=" << configs[best].learning_rate_exponent
+              << " ucb=" << configs[best].exploration_bonus << " smdp=" << configs[best].semi_mdp
+              << " levels=" << levels_name(configs[best]) << " mirror=" << configs[best].mirror_symmetry
+              << " planning=" << planning_name(configs[best]) << " grid=" << grid_name(configs[best].grid)
+              << " (win rate " << best_win_rate;
+    if (replicates > 1) std::cout << ", mean of " << replicates << " replicates";
+    std::cout << ")" << std::endl;
+    std::cout << "Total wall time: " << total_seconds << " s" << std::endl;
+
+    std::ofstream out(out_path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open output file: " << out_path << std::endl;
+        return 1;
+    }
+    out << "agent,alpha,gamma,epsilon,lr_exponent,ucb,semi_mdp,coarse_levels,refine_visits,mirror_symmetry,planning_updates,planning_us,grid_x,grid_y,paddle_y,seed,final_win_rate,steps_to_threshold,table_size,"
+           "memory_bytes,training_points,updates,action_cache_hits,action_cache_misses,wall_seconds\n";
+    for (size_t i = 0; i < configs.size(); ++i) {
+        const TrainingConfig& c = configs[i];
+        const TrainingResult& r = results[i];
+        out << agent_kind_name(c.agent) << "," << c.alpha << "," << c.gamma << "," << c.epsilon << "," << c.learning_rate_exponent << ","
+            << c.exploration_bonus << "," << c.semi_mdp << "," << c.coarse_levels << "," << c.refine_visits << "," << c.mirror_symmetry << "," << c.planning_updates << "," << c.planning_microseconds << "," << c.grid.grid_x << "," << c.grid.grid_y << ","
+            << c.grid.paddle_y << "," << c.seed << "," << r.final_win_rate << "," << r.steps_to_threshold << "," << r.table_size << ","
+            << r.memory_bytes << "," << r.training_points << "," << r.updates << "," << r.action_cache_hits << ","
+            << r.action_cache_misses << "," << r.wall_seconds << "\n";
+    }
+    std::cout << "Results written to " << out_path << std::endl;
+    return 0;
+}
@@ -0,0 +1,264 @@
+// Checks the vertical mirror symmetry that QLearningAgent::set_mirror_symmetry relies on, in two
+// parts:
+//   1. Trains a flat agent (no symmetry) and compares the values it learned for mirrored states:
+//      Q(s, a) against Q(mirror(s), mirror(a)) over pairs where both states are well visited. The
+//      same pairs compared without swapping UP and DOWN are the control. Both comparisons carry
+//      the same learning noise, which is most of the difference between any two states' values,
+//      so the margin is small (around 10% in mean |dQ|); if the game really is symmetric, the
+//      mirrored comparison must still agree more closely on both values and greedy actions.
+//   2. Trains an agent with symmetry on next to a plain reference agent that this tool folds by
+//      hand: every transition the first learns from, the reference learns with both states
+//      replaced by the smaller key of their mirrored pair (UP and DOWN swapped along). Both agents
+//      decide greedily (this tool does the exploring, and asks for each decision twice to cover
+//      the action cache), and every decision must equal the reference's mapped back through the
+//      fold, or in an unseen state its random pick. Seeded alike, they must also end up with the
+//      same values for every known state and its folded twin. Then checks that a saved table
+//      loads back into agents with and without symmetry unchanged.
+// Reports table sizes and win rates. Exits with status 1 if a check fails.
+//
+// Usage: SymmetryCheck [options]
+//   --steps N         training steps per agent (default 5000000)
+//   --min-visits N    visits every action of both states of a pair needs to be compared (default 50)
+//   --skill S         scripted opponent skill in [0, 1] (default 0.5)
+//   --seed N          random seed (default 1)
+//   --file FILE       scratch file for the save/load check (default symmetry_check_q_table.dat;
+//                     removed afterwards)
+#include "TrainingJob.h"
+#include "QLearningAgent.h"
+#include "Simulation.h"
+#include "ScriptedOpponent.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>   // For std::remove
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--steps N] [--min-visits N] [--skill S] [--seed N] [--file FILE]" << std::endl;
+}
+
+// Index of the first maximum, or -1 if it is tied with another action
+static int unique_best(const QValues& q) {
+    int best = static_cast<int>(std::max_element(q.begin(), q.end()) - q.begin());
+    for (int a = 0; a < NUM_ACTIONS; ++a) {
+        if (a != best && q[a] == q[best]) return -1;
+    }
+    return best;
+}
+
+static int mirror_index(int action_index) {
+    return static_cast<int>(mirror_action(static_cast<Action>(action_index)));
+}
+
+// The key a mirror-symmetric table stores `key` under, worked out here independently of the
+// agent: the smaller of the key and its image (states outside the grid are left alone).
+// `flipped` tells whether it was the image.
+static StateKey fold_key(StateKey key, const Discretization& grid, bool* flipped) {
+    *flipped = false;
+    if (!grid.contains(decode_state(key))) return key;
+    StateKey image = mirror_key(key, grid.grid_y, grid.paddle_y);
+    if (image < key) {
+        *flipped = true;
+        return image;
+    }
+    return key;
+}
+
+static State fold_state(const State& state, const Discretization& grid, bool* flipped) {
+    return decode_state(fold_key(encode_state(state), grid, flipped));
+}
+
+// The lines of a saved table, sorted (the order of a save depends on the table's layout)
+static std::vector<std::string> sorted_lines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) lines.push_back(line);
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+int main(int argc, char* argv[]) {
+    TrainingConfig config;
+    config.steps = 5000000; // Mirrored pairs need a few visits per action each to be compared
+    int min_visits = 50;
+    std::string scratch_path = "symmetry_check_q_table.dat";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--steps") config.steps = std::atol(value.c_str());
+        else if (arg == "--min-visits") min_visits = std::atoi(value.c_str());
+        else if (arg == "--skill") config.opponent_skill = static_cast<float>(std::atof(value.c_str()));
+        else if (arg == "--seed") config.seed = static_cast<unsigned int>(std::atol(value.c_str()));
+        else if (arg == "--file") scratch_path = value;
+        else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    const Discretization& grid = config.grid;
+    bool passed = true;
+
+    // --- 1. What a flat agent learns for mirrored states ---
+    QLearningAgent flat(config.seed);
+    TrainingResult flat_result = run_training_job(config, flat);
+
+    const QTable<QRow>& table = flat.get_q_table();
+    long pairs = 0;
+    double mirrored_error = 0.0, same_error = 0.0; // Sums of |dQ| over UP and DOWN (STAY maps to itself)
+    long compared_greedy = 0, mirrored_agree = 0, same_agree = 0;
+    auto well_visited = [min_visits](const QRow& row) {
+        return *std::min_element(row.visits.begin(), row.visits.end()) >= min_visits;
+    };
+    table.for_each([&](StateKey key, const QRow& row) {
+        if (!grid.contains(decode_state(key)) || !well_visited(row)) return;
+        StateKey image = mirror_key(key, grid.grid_y, grid.paddle_y);
+        const QRow* image_row = table.find(image);
+        if (image <= key || !image_row || !well_visited(*image_row)) return; // Each pair once
+        QValues q = flat.get_q_values(row);
+        QValues p = flat.get_q_values(*image_row);
+        pairs++;
+        for (Action action : {Action::UP, Action::DOWN}) {
+            int a = static_cast<int>(action);
+            mirrored_error += std::fabs(q[a] - p[mirror_index(a)]);
+            same_error += std::fabs(q[a] - p[a]);
+        }
+        int best_q = unique_best(q), best_p = unique_best(p);
+        if (best_q >= 0 && best_p >= 0) {
+            compared_greedy++;
+            mirrored_agree += (mirror_index(best_q) == best_p);
+            same_agree += (best_q == best_p);
+        }
+    });
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "Flat agent: " << flat_result.table_size << " states, win rate " << flat_result.final_win_rate << std::endl
+              << "  " << pairs << " mirrored pairs with >= " << min_visits << " visits per action" << std::endl;
+    if (pairs == 0 || compared_greedy == 0) {
+        std::cerr << "Error: No well-visited mirrored pairs to compare (train longer or lower --min-visits)." << std::endl;
+        return 1;
+    }
+    double mirrored_agreement = static_cast<double>(mirrored_agree) / compared_greedy;
+    double same_agreement = static_cast<double>(same_agree) / compared_greedy;
+    std::cout << "  mean |Q(s, a) - Q(m(s), m(a))|: " << mirrored_error / (2 * pairs)
+              << "   control, actions not swapped: " << same_error / (2 * pairs) << std::endl
+              << "  greedy actions mirror each other: " << mirrored_agreement
+              << "   control, same action: " << same_agreement << std::endl;
+    if (mirrored_error >= same_error || mirrored_agreement <= same_agreement) {
+        std::cout << "FAIL: mirrored states do not agree better than the control" << std::endl;
+        passed = false;
+    }
+
+    // --- 2. An agent with symmetry on, against a plain agent folded by hand ---
+    // Same seed and parameters: as long as the two agree, they draw the same random numbers
+    // (random picks in unseen states, and the rounding dither of the 16-bit storage formats), so
+    // the comparison is exact in every storage format. The agents never explore on their own,
+    // since an exploratory pick could not be told apart from a greedy one that failed to mirror
+    // back; this tool explores for them, at the same rate, with its own generator.
+    QLearningAgent mirrored(config.seed);
+    QLearningAgent reference(config.seed);
+    mirrored.set_parameters(config.alpha, config.gamma, 0.0);
+    reference.set_parameters(config.alpha, config.gamma, 0.0);
+    mirrored.set_mirror_symmetry(true, grid);
+    std::mt19937 explore_rng(config.seed + 2);
+    std::uniform_real_distribution<double> explore_draw(0.0, 1.0);
+    std::uniform_int_distribution<int> random_action(0, NUM_ACTIONS - 1);
+
+    Simulation world(config.seed);
+    world.setDiscretization(grid);
+    ScriptedOpponent opponent(config.opponent_skill, config.seed + 1);
+    long decision_mismatches = 0;
+    for (long step = 0; step < config.steps; ++step) {
+        State state = world.getRightInput<State>();
+        bool flipped = false;
+        State folded = fold_state(state, grid, &flipped);
+        // Each decision is asked for twice, so the second answer comes from the action cache.
+        // Greedy decisions come back through the fold. In an unseen state both pick at random,
+        // in the caller's frame, so the picks match as they are.
+        bool seen = reference.get_q_table().find(encode_state(folded)) != nullptr;
+        Action action = Action::STAY;
+        for (int ask = 0; ask < 2; ++ask) {
+            Action decision = mirrored.choose_action(state);
+            Action reference_action = reference.choose_action(folded);
+            Action expected = (seen && flipped) ? mirror_action(reference_action) : reference_action;
+            if (decision != expected) {
+                decision_mismatches++;
+            }
+            if (ask == 0) action = decision;
+        }
+        if (explore_draw(explore_rng) < config.epsilon) {
+            action = static_cast<Action>(random_action(explore_rng));
+        }
+        StepEvents events = world.step(config.dt, opponent.chooseAction(world, true), action);
+        State next_state = world.getRightInput<State>();
+        double reward = compute_step_reward(events, true, action, next_state);
+        mirrored.update_q_value(state, action, reward, next_state);
+        bool next_flipped = false;
+        reference.update_q_value(folded, flipped ? mirror_action(action) : action, reward,
+                                 fold_state(next_state, grid, &next_flipped));
+    }
+
+    size_t known_states = 0;
+    long value_mismatches = 0, action_mismatches = 0;
+    mirrored.for_each_known_state([&](StateKey key, const QRow&) {
+        known_states++;
+        bool flipped = false;
+        StateKey folded = fold_key(key, grid, &flipped);
+        QValues q = mirrored.get_q_values(key);
+        QValues p = reference.get_q_values(folded);
+        for (int a = 0; a < NUM_ACTIONS; ++a) {
+            if (q[a] != p[flipped ? mirror_index(a) : a]) {
+                value_mismatches++;
+                break;
+            }
+        }
+        if (unique_best(p) >= 0) {
+            Action expected = reference.best_action(decode_state(folded));
+            if (mirrored.best_action(decode_state(key)) != (flipped ? mirror_action(expected) : expected)) {
+                action_mismatches++;
+            }
+        }
+    });
+    std::cout << "Mirrored agent: " << mirrored.get_explored_state_count() << " states stored (" << known_states
+              << " known; the hand-folded reference stores " << reference.get_explored_state_count() << ")" << std::endl
+              << "  differences from the reference: " << decision_mismatches << " decisions during training, "
+              << value_mismatches << " states' values, " << action_mismatches << " greedy actions" << std::endl;
+    if (decision_mismatches > 0 || value_mismatches > 0 || action_mismatches > 0 ||
+        mirrored.get_explored_state_count() != reference.get_explored_state_count()) {
+        std::cout << "FAIL: the mirrored agent does not learn like a table folded by hand" << std::endl;
+        passed = false;
+    }
+
+    // Save, load with and without symmetry, and save again: the same states and values
+    std::string resaved_path = scratch_path + ".resaved";
+    QLearningAgent reloaded_flat(config.seed);
+    QLearningAgent reloaded(config.seed);
+    reloaded.set_mirror_symmetry(true, grid);
+    bool io_ok = mirrored.save_q_table(scratch_path) && reloaded_flat.load_q_table(scratch_path) &&
+                 reloaded.load_q_table(scratch_path) && reloaded.save_q_table(resaved_path);
+    bool round_trip = io_ok && reloaded_flat.get_explored_state_count() == known_states &&
+                      reloaded.get_explored_state_count() == mirrored.get_explored_state_count() &&
+                      sorted_lines(scratch_path) == sorted_lines(resaved_path);
+    std::remove(scratch_path.c_str());
+    std::remove(resaved_path.c_str());
+    std::cout << "  save/load round trip: " << (round_trip ? "identical" : "DIFFERENT") << " ("
+              << reloaded_flat.get_explored_state_count() << " states without symmetry, "
+              << reloaded.get_explored_state_count() << " with)" << std::endl;
+    if (!round_trip) {
+        std::cout << "FAIL: the saved table does not load back unchanged" << std::endl;
+        passed = false;
+    }
+
+    std::cout << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed ? 0 : 1;
+}